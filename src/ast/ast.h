@@ -2266,6 +2266,7 @@ typedef app_ref_buffer                proof_ref_buffer;
 // -----------------------------------
 
 typedef obj_mark<expr> expr_mark;
+typedef obj_stamp_mark<expr> expr_stamp_mark;
 
 class expr_sparse_mark {
     obj_hashtable<expr> m_marked;
@@ -66,6 +66,7 @@ void bv_decl_plugin::set_manager(ast_manager * m, family_id id) {
 
 void bv_decl_plugin::finalize() {
 #define DEC_REF(FIELD) dec_range_ref(FIELD.begin(), FIELD.end(), *m_manager)
+    DEC_REF(m_small_numerals);
     if (m_bit0) { m_manager->dec_ref(m_bit0); }
     if (m_bit1) { m_manager->dec_ref(m_bit1); }
     if (m_carry) { m_manager->dec_ref(m_carry); }
@@ -427,12 +428,39 @@ func_decl * bv_decl_plugin::mk_num_decl(unsigned num_parameters, parameter const
     // This cannot be enforced now, since some Z3 modules try to generate these invalid numerals.
     // After SMT-COMP, I should find all offending modules.
     // For now, I will just simplify the numeral here.
-    parameter p0(mod(parameters[0].get_rational(), rational::power_of_two(bv_size)));
-    parameter ps[2] = { p0, parameters[1] };
     sort * bv = get_bv_sort(bv_size);
+    rational const & val = parameters[0].get_rational();
+    if (bv_size <= 64 && val.is_uint64() && (bv_size == 64 || (val.get_uint64() >> bv_size) == 0)) {
+        // numeral is already in range.
+        return m_manager->mk_const_decl(m_bv_sym, bv, func_decl_info(m_family_id, OP_BV_NUM, num_parameters, parameters));
+    }
+    parameter p0(mod(val, rational::power_of_two(bv_size)));
+    parameter ps[2] = { p0, parameters[1] };
     return m_manager->mk_const_decl(m_bv_sym, bv, func_decl_info(m_family_id, OP_BV_NUM, num_parameters, ps));
 }
 
+#define BV_MAX_SMALL_NUM_TO_CACHE 16
+#define BV_MAX_SMALL_NUM_SIZE     64
+
+app * bv_decl_plugin::mk_numeral(rational const & val, unsigned bv_size) {
+    if (bv_size <= BV_MAX_SMALL_NUM_SIZE && val.is_unsigned()) {
+        unsigned u_val = val.get_unsigned();
+        if (u_val < BV_MAX_SMALL_NUM_TO_CACHE && (bv_size >= 32 || (u_val >> bv_size) == 0)) {
+            unsigned idx = bv_size * BV_MAX_SMALL_NUM_TO_CACHE + u_val;
+            app * r = m_small_numerals.get(idx, 0);
+            if (r == 0) {
+                parameter p[2] = { parameter(val), parameter(static_cast<int>(bv_size)) };
+                r = m_manager->mk_const(mk_num_decl(2, p, 0));
+                m_manager->inc_ref(r);
+                m_small_numerals.setx(idx, r, 0);
+            }
+            return r;
+        }
+    }
+    parameter p[2] = { parameter(val), parameter(static_cast<int>(bv_size)) };
+    return m_manager->mk_const(mk_num_decl(2, p, 0));
+}
+
 func_decl * bv_decl_plugin::mk_bit2bool(unsigned bv_size, unsigned num_parameters, parameter const * parameters,
                                         unsigned arity, sort * const * domain) {
     if (!(num_parameters == 1 && parameters[0].is_int() && arity == 1 && parameters[0].get_int() < static_cast<int>(bv_size))) {
@@ -750,6 +778,13 @@ expr * bv_decl_plugin::get_some_value(sort * s) {
 }
 
 rational bv_recognizers::norm(rational const & val, unsigned bv_size, bool is_signed) const {
+    if (!is_signed && bv_size <= 64 && val.is_uint64()) {
+        uint64 u = val.get_uint64();
+        if (bv_size < 64) {
+            u &= (1ull << bv_size) - 1ull;
+        }
+        return rational(u, rational::ui64());
+    }
     rational r = mod(val, rational::power_of_two(bv_size));
     SASSERT(!r.is_neg());
     if (is_signed) {
@@ -765,6 +800,9 @@ rational bv_recognizers::norm(rational const & val, unsigned bv_size, bool is_si
 
 bool bv_recognizers::has_sign_bit(rational const & n, unsigned bv_size) const {
     SASSERT(bv_size > 0);
+    if (bv_size <= 64 && n.is_uint64()) {
+        return ((n.get_uint64() >> (bv_size - 1)) & 1ull) != 0;
+    }
     rational m = norm(n, bv_size, false);
     rational p = rational::power_of_two(bv_size - 1);
     return m >= p;
@@ -856,9 +894,7 @@ app * bv_util::mk_numeral(rational const & val, sort* s) {
 }
 
 app * bv_util::mk_numeral(rational const & val, unsigned bv_size) {
-    parameter p1(val);
-    parameter p[2] = { p1, parameter(static_cast<int>(bv_size)) };
-    return m_manager.mk_app(get_fid(), OP_BV_NUM, 2, p, 0, 0);
+    return m_plugin->mk_numeral(val, bv_size);
 }
 
 sort * bv_util::mk_sort(unsigned bv_size) {
@@ -204,6 +204,8 @@ protected:
     vector<ptr_vector<func_decl> > m_bit2bool;
     ptr_vector<func_decl>  m_mkbv;
 
+    ptr_vector<app>        m_small_numerals;
+
     virtual void set_manager(ast_manager * m, family_id id);
     void mk_bv_sort(unsigned bv_size);
     sort * get_bv_sort(unsigned bv_size);
@@ -246,6 +248,8 @@ public:
 
     virtual decl_plugin * mk_fresh() { return alloc(bv_decl_plugin); }
 
+    app * mk_numeral(rational const & val, unsigned bv_size);
+
     virtual sort * mk_sort(decl_kind k, unsigned num_parameters, parameter const * parameters);
 
     virtual func_decl * mk_func_decl(decl_kind k, unsigned num_parameters, parameter const * parameters,
@@ -23,6 +23,7 @@ void used_vars::process(expr * n, unsigned delta) {
     unsigned j, idx;
 
     m_cache.reset();
+    m_visited.reset();
     m_todo.reset();
     m_todo.push_back(expr_delta_pair(n, delta));
 
@@ -31,14 +32,22 @@ void used_vars::process(expr * n, unsigned delta) {
 
         n     = p.m_node;
 
-        if (n->get_ref_count() > 1 && m_cache.contains(p)) {
-            m_todo.pop_back();
-            continue;
-        }
-        
         if (n->get_ref_count() > 1) {
             // cache only shared and non-constant nodes
-            m_cache.insert(p);
+            if (m_use_stamps && p.m_delta == 0) {
+                if (m_visited.is_marked(n)) {
+                    m_todo.pop_back();
+                    continue;
+                }
+                m_visited.mark(n);
+            }
+            else {
+                if (m_cache.contains(p)) {
+                    m_todo.pop_back();
+                    continue;
+                }
+                m_cache.insert(p);
+            }
         }
 
         delta = p.m_delta;
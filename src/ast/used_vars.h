@@ -26,12 +26,20 @@ class used_vars {
     ptr_vector<sort> m_found_vars;
     typedef hashtable<expr_delta_pair, obj_hash<expr_delta_pair>, default_eq<expr_delta_pair> > cache;
     cache                    m_cache;
+    expr_stamp_mark          m_visited; // shared nodes outside of binders, see m_use_stamps
+    bool                     m_use_stamps;
     svector<expr_delta_pair> m_todo;
 
     void process(expr * n, unsigned delta);
 
 public:
-    
+    /**
+       \brief When \c use_stamps is true, shared nodes outside of binders are marked in an
+       array indexed by expression id that is kept between calls. This only pays off for
+       long lived instances: the array is as large as the largest id visited.
+    */
+    used_vars(bool use_stamps = false):m_use_stamps(use_stamps) {}
+
     void operator()(expr * n) {
         m_found_vars.reset();
         process(n, 0);
@@ -323,6 +323,7 @@ cmd_context::cmd_context(bool main_ctx, ast_manager * m, symbol const & l):
     m_numeral_as_real(false),
     m_ignore_check(false),
     m_exit_on_error(false),
+    m_cmd_latency_stats(false),
     m_manager(m),
     m_own_manager(m == 0),
     m_manager_initialized(false),
@@ -1701,7 +1702,19 @@ void cmd_context::set_solver_factory(solver_factory * f) {
     }
 }
 
+void cmd_context::record_cmd_latency(symbol const & cmd, double seconds) {
+    dictionary<cmd_latency>::entry * e = m_cmd_latencies.insert_if_not_there2(cmd, cmd_latency());
+    cmd_latency & l = e->get_data().m_value;
+    l.m_count++;
+    l.m_total += seconds;
+    if (seconds > l.m_max)
+        l.m_max = seconds;
+}
+
 void cmd_context::display_statistics(bool show_total_time, double total_time) {
+    // statistics only store the key pointers, the latency keys must outlive st.
+    std::vector<std::string> latency_keys;
+    latency_keys.reserve(3 * m_cmd_latencies.size());
     statistics st;
     if (show_total_time)
         st.update("total time", total_time);
@@ -1717,6 +1730,18 @@ void cmd_context::display_statistics(bool show_total_time, double total_time) {
     else if (m_opt) {
         m_opt->collect_statistics(st);
     }
+    dictionary<cmd_latency>::iterator it  = m_cmd_latencies.begin();
+    dictionary<cmd_latency>::iterator end = m_cmd_latencies.end();
+    for (; it != end; ++it) {
+        std::string name((*it).m_key.str());
+        cmd_latency const & l = (*it).m_value;
+        latency_keys.push_back(name + " count");
+        st.update(latency_keys.back().c_str(), l.m_count);
+        latency_keys.push_back(name + " time");
+        st.update(latency_keys.back().c_str(), l.m_total);
+        latency_keys.push_back(name + " max time");
+        st.update(latency_keys.back().c_str(), l.m_max);
+    }
     st.display_smt2(regular_stream());
 }
 
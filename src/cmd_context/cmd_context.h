@@ -161,6 +161,7 @@ protected:
     bool                         m_numeral_as_real;
     bool                         m_ignore_check; // used by the API to disable check-sat() commands when parsing SMT 2.0 files.
     bool                         m_exit_on_error;
+    bool                         m_cmd_latency_stats; // collect per-command latencies (streaming mode).
     
     static std::ostringstream    g_error_stream;
 
@@ -212,6 +213,14 @@ protected:
 
     stopwatch                    m_watch;
 
+    struct cmd_latency {
+        unsigned m_count;
+        double   m_total;
+        double   m_max;
+        cmd_latency():m_count(0), m_total(0), m_max(0) {}
+    };
+    dictionary<cmd_latency>      m_cmd_latencies;
+
     class dt_eh : public new_datatype_eh {
         cmd_context &             m_owner;
         datatype_util             m_dt_util;
@@ -290,6 +299,9 @@ public:
     void set_ignore_check(bool flag) { m_ignore_check = flag; }
     void set_exit_on_error(bool flag) { m_exit_on_error = flag; }
     bool exit_on_error() const { return m_exit_on_error; }
+    void set_cmd_latency_stats(bool flag) { m_cmd_latency_stats = flag; }
+    bool cmd_latency_stats() const { return m_cmd_latency_stats; }
+    void record_cmd_latency(symbol const & cmd, double seconds);
     bool interactive_mode() const { return m_interactive_mode; }
     void set_print_success(bool flag) { m_print_success = flag; }
     bool print_success_enabled() const { return m_print_success; }
@@ -18,6 +18,7 @@ Notes:
 --*/
 #include"algebraic_numbers.h"
 #include"upolynomial.h"
+#include"upolynomial_factorization.h"
 #include"mpbq.h"
 #include"basic_interval.h"
 #include"cooperate.h"
@@ -27,6 +28,8 @@ Notes:
 #include"timeit.h"
 #include"algebraic_params.hpp"
 #include"common_msgs.h"
+#include<cmath>
+#include<limits>
 
 namespace algebraic_numbers {
 
@@ -78,6 +81,7 @@ namespace algebraic_numbers {
         scoped_upoly             m_isolate_tmp3;
         scoped_upoly             m_eval_sign_tmp;
         factors                  m_isolate_factors;
+        upolynomial::factorization_cache m_factor_cache;
         scoped_mpbq_vector       m_isolate_roots;
         scoped_mpbq_vector       m_isolate_lowers;
         scoped_mpbq_vector       m_isolate_uppers;
@@ -88,14 +92,18 @@ namespace algebraic_numbers {
         // configuration
         int                        m_min_magnitude;
         bool                       m_factor;
+        bool                       m_factor_cache_enabled;
         polynomial::factor_params  m_factor_params;
         int                        m_zero_accuracy;
+        bool                       m_fp_filter;
 
         // statistics
         unsigned                 m_compare_cheap;
         unsigned                 m_compare_sturm;
         unsigned                 m_compare_refine;
         unsigned                 m_compare_poly_eq;
+        unsigned                 m_eval_sign_fp;
+        unsigned                 m_eval_sign_exact;
 
         imp(reslimit& lim, manager & w, unsynch_mpq_manager & m, params_ref const & p, small_object_allocator & a):
             m_limit(lim),
@@ -112,6 +120,7 @@ namespace algebraic_numbers {
             m_isolate_tmp3(upm()),
             m_eval_sign_tmp(upm()),
             m_isolate_factors(upm()),
+            m_factor_cache(upm()),
             m_isolate_roots(bqm()),
             m_isolate_lowers(bqm()),
             m_isolate_uppers(bqm()),
@@ -136,6 +145,9 @@ namespace algebraic_numbers {
             m_compare_sturm   = 0;
             m_compare_refine  = 0;
             m_compare_poly_eq = 0;
+            m_eval_sign_fp    = 0;
+            m_eval_sign_exact = 0;
+            m_factor_cache.reset_statistics();
         }
 
         void collect_statistics(statistics & st) {
@@ -145,16 +157,24 @@ namespace algebraic_numbers {
             st.update("algebraic compare refine", m_compare_refine);
             st.update("algebraic compare poly", m_compare_poly_eq);
 #endif
+            st.update("algebraic eval sign fp", m_eval_sign_fp);
+            st.update("algebraic eval sign exact", m_eval_sign_exact);
+            st.update("algebraic factor cache hits", m_factor_cache.hits());
+            st.update("algebraic factor cache misses", m_factor_cache.misses());
         }
 
         void updt_params(params_ref const & _p) {
             algebraic_params p(_p);
             m_min_magnitude            = -static_cast<int>(p.min_mag());
             m_factor                   = p.factor();
+            m_factor_cache_enabled     = p.factor_cache();
             m_factor_params.m_max_p    = p.factor_max_prime();
             m_factor_params.m_p_trials = p.factor_num_primes();
             m_factor_params.m_max_search_size = p.factor_search_size();
             m_zero_accuracy            = -static_cast<int>(p.zero_accuracy());
+            m_fp_filter                = p.fp_filter();
+            // cached factorizations depend on the factor parameters
+            m_factor_cache.reset();
         }
 
         unsynch_mpq_manager & qm() {
@@ -540,6 +560,8 @@ namespace algebraic_numbers {
 
         bool factor(scoped_upoly const & up, factors & r) {
             if (m_factor) {
+                if (m_factor_cache_enabled)
+                    return m_factor_cache.factor(up, r, m_factor_params);
                 return upm().factor(up, r, m_factor_params);
             }
             else {
@@ -1975,10 +1997,148 @@ namespace algebraic_numbers {
             }
         };
 
+        /**
+           \brief Interval with double end points used to filter sign evaluations.
+           Operations are executed in the current rounding mode, whose error is below
+           one ulp, and the end points of every result are moved one ulp outwards.
+           So, the interval always contains the exact value.
+        */
+        struct dinterval {
+            double m_lower;
+            double m_upper;
+            dinterval():m_lower(0.0), m_upper(0.0) {}
+            dinterval(double l, double u):m_lower(l), m_upper(u) {}
+        };
+
+        static double dprev(double v) { return std::nextafter(v, -std::numeric_limits<double>::infinity()); }
+        static double dnext(double v) { return std::nextafter(v, std::numeric_limits<double>::infinity()); }
+
+        static bool mk_dinterval(double l, double u, dinterval & r) {
+            r.m_lower = dprev(l);
+            r.m_upper = dnext(u);
+            return std::isfinite(r.m_lower) && std::isfinite(r.m_upper);
+        }
+
+        static bool dmul(dinterval const & a, dinterval const & b, dinterval & r) {
+            double p1 = a.m_lower * b.m_lower;
+            double p2 = a.m_lower * b.m_upper;
+            double p3 = a.m_upper * b.m_lower;
+            double p4 = a.m_upper * b.m_upper;
+            return mk_dinterval(std::min(std::min(p1, p2), std::min(p3, p4)), std::max(std::max(p1, p2), std::max(p3, p4)), r);
+        }
+
+        static bool dadd(dinterval const & a, dinterval const & b, dinterval & r) {
+            return mk_dinterval(a.m_lower + b.m_lower, a.m_upper + b.m_upper, r);
+        }
+
+        bool to_dinterval(mpz const & a, dinterval & r) {
+            if (!qm().is_int64(a))
+                return false;
+            int64 v = qm().get_int64(a);
+            double d = static_cast<double>(v);
+            if (-(1ll << 53) <= v && v <= (1ll << 53)) {
+                // exact conversion
+                r = dinterval(d, d);
+                return true;
+            }
+            return mk_dinterval(d, d, r);
+        }
+
+        bool to_dinterval(mpq const & a, dinterval & r) {
+            if (!to_dinterval(a.numerator(), r))
+                return false;
+            if (qm().is_one(a.denominator()))
+                return true;
+            dinterval d;
+            if (!to_dinterval(a.denominator(), d))
+                return false;
+            // the denominator is positive
+            double l = std::min(r.m_lower / d.m_lower, r.m_lower / d.m_upper);
+            double u = std::max(r.m_upper / d.m_lower, r.m_upper / d.m_upper);
+            return mk_dinterval(l, u, r);
+        }
+
+        bool to_dinterval(mpbq const & a, dinterval & r) {
+            if (a.k() > 512 || !to_dinterval(a.numerator(), r))
+                return false;
+            if (a.k() == 0)
+                return true;
+            int k = -static_cast<int>(a.k());
+            return mk_dinterval(std::ldexp(r.m_lower, k), std::ldexp(r.m_upper, k), r);
+        }
+
+        bool to_dinterval(anum const & v, dinterval & r) {
+            if (v.is_basic())
+                return to_dinterval(basic_value(v), r);
+            mpbqi const & i = v.to_algebraic()->m_interval;
+            dinterval l, u;
+            if (!to_dinterval(i.lower(), l) || !to_dinterval(i.upper(), u))
+                return false;
+            r = dinterval(l.m_lower, u.m_upper);
+            return true;
+        }
+
+        /**
+           \brief Try to determine the sign of p at x2v using intervals with double end points.
+           Return false if the interval computed for p contains zero, or some coefficient or
+           value does not fit in a double.
+        */
+        bool fp_eval_sign_at(polynomial_ref const & p, polynomial::var2anum const & x2v, int & sign) {
+            polynomial::manager & ext_pm = p.m();
+            dinterval r, t, x, xk;
+            unsigned sz = ext_pm.size(p);
+            for (unsigned i = 0; i < sz; i++) {
+                if (!to_dinterval(ext_pm.coeff(p, i), t))
+                    return false;
+                polynomial::monomial * mon = ext_pm.get_monomial(p, i);
+                unsigned msz = ext_pm.size(mon);
+                for (unsigned j = 0; j < msz; j++) {
+                    polynomial::var y = ext_pm.get_var(mon, j);
+                    if (!x2v.contains(y) || !to_dinterval(x2v(y), x))
+                        return false;
+                    unsigned d = ext_pm.degree(mon, j);
+                    xk = x;
+                    for (unsigned k = 1; k < d; k++) {
+                        if (!dmul(xk, x, xk))
+                            return false;
+                    }
+                    if (d % 2 == 0 && xk.m_lower < 0.0)
+                        xk.m_lower = 0.0;
+                    if (!dmul(t, xk, t))
+                        return false;
+                }
+                if (i == 0)
+                    r = t;
+                else if (!dadd(r, t, r))
+                    return false;
+            }
+            if (r.m_lower > 0.0) {
+                sign = 1;
+                return true;
+            }
+            if (r.m_upper < 0.0) {
+                sign = -1;
+                return true;
+            }
+            return false;
+        }
+
         polynomial::var_vector m_eval_sign_vars;
         int eval_sign_at(polynomial_ref const & p, polynomial::var2anum const & x2v) {
-            polynomial::manager & ext_pm = p.m();
             TRACE("anum_eval_sign", tout << "evaluating sign of: " << p << "\n";);
+            int fp_sign;
+            if (m_fp_filter && fp_eval_sign_at(p, x2v, fp_sign)) {
+                TRACE("anum_eval_sign", tout << "sign determined using floating point intervals: " << fp_sign << "\n";);
+                SASSERT(fp_sign == exact_eval_sign_at(p, x2v));
+                m_eval_sign_fp++;
+                return fp_sign;
+            }
+            m_eval_sign_exact++;
+            return exact_eval_sign_at(p, x2v);
+        }
+
+        int exact_eval_sign_at(polynomial_ref const & p, polynomial::var2anum const & x2v) {
+            polynomial::manager & ext_pm = p.m();
             while (true) {
                 bool restart = false;
                 // Optimistic: maybe x2v contains only rational values
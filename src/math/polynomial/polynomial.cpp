@@ -161,13 +161,22 @@ namespace polynomial {
         unsigned  m_total_degree; //!< total degree of the monomial
         unsigned  m_size;         //!< number of powers
         unsigned  m_hash;
+        uint64    m_vars_mask;    //!< bit (x % 64) is set for every variable x in the monomial
         power     m_powers[0];
         friend class tmp_monomial;
 
         void sort() {
             std::sort(m_powers, m_powers + m_size, power::lt_var());
         }
+
+        void init_vars_mask() {
+            m_vars_mask = 0;
+            for (unsigned i = 0; i < m_size; i++)
+                m_vars_mask |= var_bit(get_var(i));
+        }
     public:
+        static uint64 var_bit(var x) { return 1ull << (x & 63); }
+
         static unsigned hash_core(unsigned sz, power const * pws) {
             return string_hash(reinterpret_cast<char*>(const_cast<power*>(pws)), sz*sizeof(power), 11);
         }
@@ -199,13 +208,15 @@ namespace polynomial {
             m_id(id),
             m_total_degree(0),
             m_size(sz),
-            m_hash(h) {
+            m_hash(h),
+            m_vars_mask(0) {
             for (unsigned i = 0; i < sz; i ++) {
                 power const & pw = pws[i];
                 m_powers[i] = pw;
                 SASSERT(i == 0 || get_var(i) > get_var(i-1));
                 SASSERT(degree(i) > 0);
                 m_total_degree += degree(i);
+                m_vars_mask    |= var_bit(pw.get_var());
             }
         }
 
@@ -227,6 +238,13 @@ namespace polynomial {
 
         unsigned total_degree() const { return m_total_degree; }
 
+        /**
+           \brief Variables of the monomial packed in a machine word (see var_bit).
+           If the bit of x is not set, then x does not occur in the monomial, and if
+           the mask of m2 is not a subset of the mask of m1, then m2 does not divide m1.
+        */
+        uint64 vars_mask() const { return m_vars_mask; }
+
         power const & get_power(unsigned idx) const { SASSERT(idx < size()); return m_powers[idx]; }
 
         power const * get_powers() const { return m_powers; }
@@ -250,7 +268,7 @@ namespace polynomial {
 #define SMALL_MONOMIAL 8
 
         unsigned index_of(var x) const {
-            if (m_size == 0)
+            if ((m_vars_mask & var_bit(x)) == 0)
                 return UINT_MAX;
             unsigned last = m_size - 1;
             if (get_var(last) == x)
@@ -447,6 +465,7 @@ namespace polynomial {
             }
             sort();
             m_hash = hash_core(m_size, m_powers);
+            init_vars_mask();
         }
     };
 
@@ -1043,7 +1062,7 @@ namespace polynomial {
         }
 
         bool div(monomial const * m1, monomial const * m2) {
-            if (m1->total_degree() < m2->total_degree())
+            if (m1->total_degree() < m2->total_degree() || (m2->vars_mask() & ~m1->vars_mask()) != 0)
                 return false;
             if (m1 == m2)
                 return true;
@@ -1051,7 +1070,7 @@ namespace polynomial {
         }
 
         bool div(monomial const * m1, monomial const * m2, monomial * & r) {
-            if (m1->total_degree() < m2->total_degree())
+            if (m1->total_degree() < m2->total_degree() || (m2->vars_mask() & ~m1->vars_mask()) != 0)
                 return false;
             if (m1 == m2) {
                 r = m_unit;
@@ -1145,7 +1164,8 @@ namespace polynomial {
         }
 
         monomial * gcd(monomial const * m1, monomial const * m2, monomial * & q1, monomial * & q2) {
-            if (gcd_core(m1->size(), m1->get_powers(), m2->size(), m2->get_powers(), m_tmp1, m_tmp2, m_tmp3)) {
+            if ((m1->vars_mask() & m2->vars_mask()) != 0 &&
+                gcd_core(m1->size(), m1->get_powers(), m2->size(), m2->get_powers(), m_tmp1, m_tmp2, m_tmp3)) {
                 q1 = mk_monomial(m_tmp2);
                 q2 = mk_monomial(m_tmp3);
                 return mk_monomial(m_tmp1);
@@ -1159,7 +1179,8 @@ namespace polynomial {
         }
 
         bool unify(monomial const * m1, monomial const * m2, monomial * & q1, monomial * & q2) {
-            if (gcd_core(m1->size(), m1->get_powers(), m2->size(), m2->get_powers(), m_tmp1, m_tmp2, m_tmp3)) {
+            if ((m1->vars_mask() & m2->vars_mask()) != 0 &&
+                gcd_core(m1->size(), m1->get_powers(), m2->size(), m2->get_powers(), m_tmp1, m_tmp2, m_tmp3)) {
                 q1 = mk_monomial(m_tmp2);
                 q2 = mk_monomial(m_tmp3);
                 return true;
@@ -1849,6 +1870,7 @@ namespace polynomial {
         unsigned_vector          m_degree2pos;
         bool                     m_use_sparse_gcd;
         bool                     m_use_prs_gcd;
+        bool                     m_use_modular_psc;
 
         // Debugging method: check if the coefficients of p are in the numeral_manager.
         bool consistent_coeffs(polynomial const * p) {
@@ -2324,6 +2346,7 @@ namespace polynomial {
             inc_ref(m_unit_poly);
             m_use_sparse_gcd = true;
             m_use_prs_gcd = false;
+            m_use_modular_psc = true;
         }
 
         imp(reslimit& lim, manager & w, unsynch_mpz_manager & m, monomial_manager * mm):
@@ -5384,6 +5407,14 @@ namespace polynomial {
                 pw(B, degree(A, x), result);
                 return;
             }
+            if (m_use_modular_psc && !m().modular() && is_univariate(A) && is_univariate(B) &&
+                degree(A, x) > 0 && degree(B, x) > 0) {
+                polynomial_ref_vector R(pm());
+                if (modular_psc(A, B, x, true, R)) {
+                    result = R.get(0);
+                    return;
+                }
+            }
 
             // decompose A and B into
             //   A = iA*cA*ppA
@@ -5903,9 +5934,378 @@ namespace polynomial {
             // psc_chain1(A, B, x, S);
             // psc_chain2(A, B, x, S);
             // psc_chain_classic(A, B, x, S);
+            if (m_use_modular_psc && !m().modular() && is_univariate(A) && is_univariate(B) &&
+                degree(A, x) > 0 && degree(B, x) > 0 && modular_psc(A, B, x, false, S))
+                return;
             psc_chain_optimized(A, B, x, S);
         }
 
+        /**
+           \brief Return p with its coefficients reduced modulo the current prime.
+           Remark: unlike normalize, the content of p is not removed, since it matters for resultants.
+        */
+        polynomial * mod_p(polynomial const * p) {
+            SASSERT(m().modular());
+            SASSERT(m_cheap_som_buffer.empty());
+            scoped_numeral a(m_manager);
+            unsigned sz = p->size();
+            for (unsigned i = 0; i < sz; i++) {
+                m_manager.set(a, p->a(i));
+                m_cheap_som_buffer.add_reset(a, p->m(i));
+            }
+            return m_cheap_som_buffer.mk();
+        }
+
+        /**
+           \brief Store in r the square of Hadamard's bound for the resultant and principal subresultant
+           coefficients of the univariate polynomials p and q.
+
+           They are determinants of submatrices of the Sylvester matrix, which has deg(q, x) rows
+           containing the coefficients of p and deg(p, x) rows containing the coefficients of q.
+           So, their absolute values are at most ||p||^deg(q, x) * ||q||^deg(p, x), where ||p|| is the
+           euclidean norm of the vector of coefficients of p.
+        */
+        void psc_hadamard_bound2(polynomial const * p, polynomial const * q, var x, numeral & r) {
+            SASSERT(!m().modular());
+            scoped_numeral np(m()), nq(m()), a(m());
+            unsigned sz = p->size();
+            for (unsigned i = 0; i < sz; i++) {
+                m().mul(p->a(i), p->a(i), a);
+                m().add(np, a, np);
+            }
+            sz = q->size();
+            for (unsigned i = 0; i < sz; i++) {
+                m().mul(q->a(i), q->a(i), a);
+                m().add(nq, a, nq);
+            }
+            m().power(np, degree(q, x), np);
+            m().power(nq, degree(p, x), nq);
+            m().mul(np, nq, r);
+        }
+
+        /**
+           \brief Dense univariate polynomials in Zp[x] where p is a word-size prime.
+           They are used to compute the images of resultants and principal subresultant
+           coefficients of univariate polynomials without going through the polynomial
+           (and mpz) machinery. The i-th position contains the coefficient of x^i,
+           coefficients are in [0, p), and the last one is not zero.
+        */
+        typedef svector<uint64> zp_upoly;
+
+        class zp_upoly_manager {
+            uint64 m_p;
+        public:
+            zp_upoly_manager(uint64 p):m_p(p) { SASSERT(p < (1ull << 31)); }
+
+            uint64 mul(uint64 a, uint64 b) const { return (a * b) % m_p; }
+            uint64 add(uint64 a, uint64 b) const { return (a + b) % m_p; }
+            uint64 sub(uint64 a, uint64 b) const { return (a + m_p - b) % m_p; }
+            uint64 neg(uint64 a) const { return a == 0 ? 0 : m_p - a; }
+
+            uint64 power(uint64 a, unsigned k) const {
+                uint64 r = 1;
+                while (k > 0) {
+                    if (k & 1)
+                        r = mul(r, a);
+                    a = mul(a, a);
+                    k >>= 1;
+                }
+                return r;
+            }
+
+            // Fermat's little theorem
+            uint64 inv(uint64 a) const { SASSERT(a != 0); return power(a, static_cast<unsigned>(m_p - 2)); }
+
+            static unsigned degree(zp_upoly const & a) { SASSERT(!a.empty()); return a.size() - 1; }
+            static uint64 lc(zp_upoly const & a) { return a.empty() ? 0 : a.back(); }
+            static uint64 coeff(zp_upoly const & a, unsigned k) { return k < a.size() ? a[k] : 0; }
+
+            static void trim(zp_upoly & a) {
+                while (!a.empty() && a.back() == 0)
+                    a.pop_back();
+            }
+
+            // a <- x*a
+            static void mul_x(zp_upoly & a) {
+                if (a.empty())
+                    return;
+                a.push_back(0);
+                for (unsigned i = a.size() - 1; i > 0; i--)
+                    a[i] = a[i-1];
+                a[0] = 0;
+            }
+
+            // a <- c*a
+            void mul(uint64 c, zp_upoly & a) const {
+                if (c == 0) {
+                    a.reset();
+                    return;
+                }
+                for (unsigned i = 0; i < a.size(); i++)
+                    a[i] = mul(c, a[i]);
+            }
+
+            // a <- a + c*x^k*b
+            void addmul(zp_upoly & a, uint64 c, unsigned k, zp_upoly const & b) const {
+                if (a.size() < b.size() + k)
+                    a.resize(b.size() + k, 0);
+                for (unsigned i = 0; i < b.size(); i++)
+                    a[i + k] = add(a[i + k], mul(c, b[i]));
+                trim(a);
+            }
+
+            // a <- a mod b
+            void rem(zp_upoly & a, zp_upoly const & b) const {
+                SASSERT(!b.empty());
+                uint64 inv_lc = inv(lc(b));
+                while (!a.empty() && a.size() >= b.size()) {
+                    unsigned k = a.size() - b.size();
+                    addmul(a, neg(mul(lc(a), inv_lc)), k, b);
+                }
+            }
+
+            /**
+               \brief Return the resultant of a and b.
+               Res(a, b) = (-1)^(deg(a)*deg(b)) lc(b)^(deg(a) - deg(r)) Res(b, r) where r = a mod b.
+            */
+            uint64 resultant(zp_upoly a, zp_upoly b) const {
+                uint64 r = 1;
+                while (true) {
+                    if (a.empty() || b.empty())
+                        return 0;
+                    unsigned m = degree(a);
+                    unsigned n = degree(b);
+                    if (n == 0)
+                        return mul(r, power(lc(b), m));
+                    if (m == 0)
+                        return mul(r, power(lc(a), n));
+                    uint64 lc_b = lc(b);
+                    rem(a, b);
+                    if (a.empty())
+                        return 0;
+                    r = mul(r, power(lc_b, m - degree(a)));
+                    if ((m * n) % 2 == 1)
+                        r = neg(r);
+                    a.swap(b);
+                }
+            }
+
+            // S_e computation used in psc_chain, see Se_Lazard.
+            void Se_Lazard(unsigned d, uint64 lc_S_d, zp_upoly const & S_d_1, zp_upoly & S_e) const {
+                unsigned n = d - degree(S_d_1) - 1;
+                S_e = S_d_1;
+                mul(power(mul(lc(S_d_1), inv(lc_S_d)), n), S_e);
+            }
+
+            // S_{e-1} computation used in psc_chain, see optimized_S_e_1.
+            void optimized_S_e_1(unsigned d, unsigned e, zp_upoly const & A, zp_upoly const & S_d_1, zp_upoly const & S_e, uint64 s,
+                                 zp_upoly & S_e_1) const {
+                uint64 c_d_1     = lc(S_d_1);
+                uint64 inv_c_d_1 = inv(c_d_1);
+                uint64 s_e       = lc(S_e);
+                // H <- H_{j}, D <- Sum coeff(A,j) * H_j for j < d
+                zp_upoly D, H;
+                D.resize(e, 0);
+                for (unsigned j = 0; j < e; j++)
+                    D[j] = mul(coeff(A, j), s_e);
+                trim(D);
+                // H_e <- s_e * x^e - S_e
+                H.resize(e + 1, 0);
+                H[e] = s_e;
+                addmul(H, neg(1), 0, S_e);
+                addmul(D, coeff(A, e), 0, H);
+                for (unsigned j = e + 1; j <= d - 1; j++) {
+                    // H_j <- x H_{j-1} - (coeff(x H_{j-1}, e) * S_{d-1})/c_{d-1}
+                    mul_x(H);
+                    addmul(H, neg(mul(coeff(H, e), inv_c_d_1)), 0, S_d_1);
+                    addmul(D, coeff(A, j), 0, H);
+                }
+                mul(inv(lc(A)), D);
+                // S_e_1 = (-1)^(d-e+1) [c_{d-1} (x H[d-1] + D) - coeff(x H[d-1], e)*S_d-1]/s
+                mul_x(H);
+                uint64 xHe = coeff(H, e);
+                S_e_1 = H;
+                addmul(S_e_1, 1, 0, D);
+                mul(c_d_1, S_e_1);
+                addmul(S_e_1, neg(xHe), 0, S_d_1);
+                uint64 c = inv(s);
+                if ((d - e + 1) % 2 == 1)
+                    c = neg(c);
+                mul(c, S_e_1);
+            }
+
+            /**
+               \brief Dense version of psc_chain_optimized_core.
+               Store in S[i] the principal subresultant coefficient of index i.
+               S must have size min(deg(P), deg(Q)) and be initialized with zeros.
+            */
+            void psc_chain(zp_upoly const & P, zp_upoly const & Q, svector<uint64> & S) const {
+                unsigned degP = degree(P);
+                unsigned degQ = degree(Q);
+                SASSERT(degP >= degQ && degQ > 0);
+                zp_upoly A, B, C;
+                uint64 s = power(lc(Q), degP - degQ);
+                A = Q;
+                // B <- prem(P, -Q)
+                B = P;
+                rem(B, Q);
+                mul(power(neg(lc(Q)), degP - degQ + 1), B);
+                while (true) {
+                    if (B.empty())
+                        return;
+                    unsigned d = degree(A);
+                    unsigned e = degree(B);
+                    // B is S_{d-1}
+                    S[d-1] = coeff(B, d-1);
+                    if (d - e > 1) {
+                        Se_Lazard(d, s, B, C);
+                        S[e] = coeff(C, e);
+                    }
+                    else {
+                        C = B;
+                    }
+                    if (e == 0)
+                        return;
+                    zp_upoly S_e_1;
+                    optimized_S_e_1(d, e, A, B, C, s, S_e_1);
+                    B.swap(S_e_1);
+                    A.swap(C);
+                    s = lc(A);
+                }
+            }
+        };
+
+        /**
+           \brief Store in r the dense representation of the univariate polynomial p in Zp[x].
+        */
+        void to_zp_upoly(polynomial const * p, var x, zp_upoly & r) {
+            SASSERT(m().modular());
+            uint64 prime = m().m().get_uint64(m().p());
+            r.reset();
+            r.resize(degree(p, x) + 1, 0);
+            unsigned sz = p->size();
+            for (unsigned i = 0; i < sz; i++) {
+                int64 a = m().m().get_int64(p->a(i));
+                if (a < 0)
+                    a += prime;
+                r[p->m(i)->degree_of(x)] = static_cast<uint64>(a);
+            }
+        }
+
+        /**
+           \brief Store in images the images in Zp of the resultant (res == true) or of the principal subresultant
+           coefficients S_0, ..., S_{n-1} of the univariate polynomials p and q, where n = min(deg(p, x), deg(q, x)).
+        */
+        void zp_psc_images(polynomial const * p, polynomial const * q, var x, bool res, polynomial_ref_vector & images) {
+            SASSERT(m().modular());
+            SASSERT(is_univariate(p) && is_univariate(q));
+            unsigned deg_p = degree(p, x);
+            unsigned deg_q = degree(q, x);
+            zp_upoly_manager um(m().m().get_uint64(m().p()));
+            zp_upoly P, Q;
+            to_zp_upoly(p, x, P);
+            to_zp_upoly(q, x, Q);
+            scoped_numeral a(m());
+            images.reset();
+            if (res) {
+                m().set(a, um.resultant(P, Q));
+                images.push_back(mk_const(a));
+                return;
+            }
+            unsigned n = std::min(deg_p, deg_q);
+            svector<uint64> S;
+            S.resize(n, 0);
+            if (deg_p >= deg_q)
+                um.psc_chain(P, Q, S);
+            else
+                um.psc_chain(Q, P, S);
+            for (unsigned i = 0; i < n; i++) {
+                m().set(a, S[i]);
+                images.push_back(mk_const(a));
+            }
+        }
+
+        /**
+           \brief Modular algorithm for resultants (res == true) and principal subresultant coefficients
+           of univariate polynomials. The images modulo different word-size primes are combined using the
+           Chinese remainder theorem until the product of the primes exceeds twice Hadamard's bound.
+           Primes that decrease the degree of p or q in x are skipped, for the other ones the
+           principal subresultant coefficients of the images are the images of the principal subresultant coefficients.
+
+           Return false if there are not enough primes, and S was not modified.
+        */
+        bool modular_psc(polynomial const * p, polynomial const * q, var x, bool res, polynomial_ref_vector & S) {
+            SASSERT(!m().modular());
+            SASSERT(is_univariate(p) && is_univariate(q));
+            unsigned deg_p = degree(p, x);
+            unsigned deg_q = degree(q, x);
+            SASSERT(deg_p > 0 && deg_q > 0);
+            unsigned n = res ? 1 : std::min(deg_p, deg_q);
+            // The product of the primes must be greater than twice the bound, bound2 = (2*bound)^2
+            scoped_numeral bound2(m()), prod(m()), prod2(m()), prime(m()), inv(m());
+            psc_hadamard_bound2(p, q, x, bound2);
+            m().mul2k(bound2, 2);
+            TRACE("modular_psc", tout << "p: " << polynomial_ref(const_cast<polynomial*>(p), pm()) << "\nq: "
+                  << polynomial_ref(const_cast<polynomial*>(q), pm()) << "\nbound2: " << bound2 << "\n";);
+            polynomial_ref p_Zp(pm()), q_Zp(pm()), r(pm());
+            polynomial_ref_vector images(pm()), C(pm()), deltas(pm());
+            for (unsigned i = 0; i < NUM_BIG_PRIMES; i++) {
+                checkpoint();
+                m().set(prime, g_big_primes[i]);
+                deltas.reset();
+                {
+                    scoped_set_zp setZp(m_wrapper, prime);
+                    p_Zp = mod_p(p);
+                    q_Zp = mod_p(q);
+                    if (degree(p_Zp, x) < deg_p || degree(q_Zp, x) < deg_q)
+                        continue; // bad prime, leading coefficient vanished
+                    zp_psc_images(p_Zp, q_Zp, x, res, images);
+                    if (!C.empty()) {
+                        // Garner's step: C_new = C + prod * ((image - C) / prod mod prime)
+                        // The coefficients of C_new are in the symmetric range for prod*prime.
+                        m().set(inv, prod);
+                        m().inv(inv);
+                        for (unsigned j = 0; j < n; j++) {
+                            r = mod_p(C.get(j));
+                            r = sub(images.get(j), r);
+                            r = mul(inv, r);
+                            deltas.push_back(r);
+                        }
+                    }
+                }
+                if (C.empty()) {
+                    C.append(images);
+                    m().set(prod, prime);
+                }
+                else {
+                    for (unsigned j = 0; j < n; j++) {
+                        r = mul(prod, deltas.get(j));
+                        r = add(C.get(j), r);
+                        C.set(j, r);
+                    }
+                    m().mul(prod, prime, prod);
+                }
+                m().mul(prod, prod, prod2);
+                if (m().gt(prod2, bound2)) {
+                    TRACE("modular_psc", tout << "number of primes: " << i + 1 << "\n";);
+                    S.reset();
+                    if (res) {
+                        S.push_back(C.get(0));
+                        return true;
+                    }
+                    // psc_chain convention: nonzero coefficients from the lowest to the highest index.
+                    for (unsigned j = 0; j < n; j++) {
+                        if (!is_zero(C.get(j)))
+                            S.push_back(C.get(j));
+                    }
+                    if (S.empty())
+                        S.push_back(mk_zero());
+                    return true;
+                }
+            }
+            return false;
+        }
+
         polynomial * normalize(polynomial const * p) {
             if (is_zero(p))
                 return const_cast<polynomial*>(p);
@@ -7274,6 +7674,10 @@ namespace polynomial {
         m_imp->psc_chain(p, q, x, S);
     }
 
+    void manager::set_modular_psc(bool flag) {
+        m_imp->m_use_modular_psc = flag;
+    }
+
     bool manager::is_pos(polynomial const * p) {
         return m_imp->is_pos(p);
     }
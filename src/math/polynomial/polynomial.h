@@ -846,6 +846,12 @@ namespace polynomial {
            \brief Store in S the principal subresultant coefficients for p and q.
         */
         void psc_chain(polynomial const * p, polynomial const * q, var x, polynomial_ref_vector & S);
+
+        /**
+           \brief Enable/disable the modular (Chinese remainder) algorithm used by resultant and psc_chain
+           for univariate polynomials over Z. It is enabled by default.
+        */
+        void set_modular_psc(bool flag);
         
         /**
            \brief Make sure the GCD of the coefficients is one.
@@ -26,6 +26,8 @@ Notes:
 #include"util.h"
 #include"upolynomial_factorization_int.h"
 #include"prime_generator.h"
+#include"chashtable.h"
+#include"hash.h"
 
 using namespace std;
 
@@ -1010,6 +1012,33 @@ static unsigned mignotte_bound(z_manager & upm, numeral_vector const & f, numera
     return e;
 }
 
+/**
+   \brief Store in bound |lc(f)|*(|f| + (n-1)*|lc(f)|), where n = deg(f) and |f| is (an upper approximation of) the
+   euclidean norm of f. Return true if 2*bound < pe, i.e., if the bound can be represented in Z_{pe}.
+*/
+static bool trace_bound_for_factors(z_manager & upm, numeral_vector const & f, numeral const & pe, numeral & bound) {
+    numeral_manager & nm = upm.m();
+    SASSERT(upm.degree(f) >= 1);
+    scoped_numeral f_norm(nm);
+    for (unsigned i = 0; i < f.size(); ++ i) {
+        if (!nm.is_zero(f[i])) {
+            nm.addmul(f_norm, f[i], f[i], f_norm);
+        }
+    }
+    nm.root(f_norm, 2);
+    nm.inc(f_norm);
+    scoped_numeral lc(nm);
+    nm.set(lc, f.back());
+    nm.abs(lc);
+    nm.set(bound, upm.degree(f) - 1);
+    nm.mul(bound, lc, bound);
+    nm.add(bound, f_norm, bound);
+    nm.mul(bound, lc, bound);
+    scoped_numeral bound2(nm);
+    nm.mul2k(bound, 1, bound2);
+    return nm.lt(bound2, pe);
+}
+
 /**
    \brief Given f from Z[x] that is square free, it factors it.
    This method also assumes f is primitive.
@@ -1179,6 +1208,13 @@ bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs,
     // the leading coefficient of f_pp mod p^e
     scoped_numeral f_pp_lc(nm);
     zpe_nm.set(f_pp_lc, f_pp.back());
+
+    // trace (d-1) test: if g is a factor of degree d of f_pp, then the coefficient of x^{d-1} in lc(f_pp)*g/lc(g)
+    // is bounded by |lc(f_pp)|*(|f_pp| + (n-1)|lc(f_pp)|), n = deg(f_pp), see the Mignotte bound above.
+    // Since it is only a sum, we use it to discard combinations before computing the products.
+    // It is only sound if the bound can be represented in Z_{p^e}.
+    scoped_numeral trace_bound(nm);
+    bool use_trace_test = trace_bound_for_factors(upm, f_pp, zpe_nm.p(), trace_bound);
     
     // we always keep in f_pp the the actual primitive part f_pp*lc(f_pp)
     upm.mul(f_pp, f_pp_lc);
@@ -1195,6 +1231,8 @@ bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs,
     bool result = true;
     bool remove = false;
     unsigned counter = 0;
+    unsigned trace_pruned = 0;
+    scoped_numeral trace(nm);
     while (it.next(remove)) {
         upm.checkpoint();
         counter++;
@@ -1209,6 +1247,19 @@ bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs,
         // but, if we take the rest and it works, it doesn't mean that the rest is factorized, so we still take out
         // the original factor
         bool using_left = it.current_degree() <= zp_fs.get_degree()/2;
+        if (use_trace_test) {
+            if (using_left)
+                it.get_left_trace_coeff(f_pp_lc, trace);
+            else
+                it.get_right_trace_coeff(f_pp_lc, trace);
+            nm.abs(trace);
+            if (nm.gt(trace, trace_bound)) {
+                trace_pruned++;
+                // don't remove this combination
+                remove = false;
+                continue;
+            }
+        }
         if (using_left) {
             // do a quick check first
             scoped_numeral tmp(nm);
@@ -1276,7 +1327,7 @@ bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs,
         );
     }
 #ifndef _EXTERNAL_RELEASE 
-    IF_VERBOSE(FACTOR_VERBOSE_LVL, verbose_stream() << "(polynomial-factorization :search-size " << counter << ")" << std::endl;);
+    IF_VERBOSE(FACTOR_VERBOSE_LVL, verbose_stream() << "(polynomial-factorization :search-size " << counter << " :trace-pruned " << trace_pruned << ")" << std::endl;);
 #endif
 
     // add the what's left to the factors (if not a constant)
@@ -1296,4 +1347,137 @@ bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs,
     return factor_square_free(upm, f, fs, 1, params);
 }
 
+struct factorization_cache::imp {
+    struct entry {
+        numeral_vector m_p;
+        unsigned       m_hash;
+        factors *      m_factors;
+        bool           m_full;
+        entry():m_hash(0), m_factors(0), m_full(false) {}
+
+        struct hash_proc { unsigned operator()(entry const * e) const { return e->m_hash; } };
+
+        struct eq_proc {
+            numeral_manager & m;
+            eq_proc(numeral_manager & _m):m(_m) {}
+            bool operator()(entry const * e1, entry const * e2) const {
+                if (e1->m_hash != e2->m_hash || e1->m_p.size() != e2->m_p.size())
+                    return false;
+                for (unsigned i = 0; i < e1->m_p.size(); ++ i) {
+                    if (!m.eq(e1->m_p[i], e2->m_p[i]))
+                        return false;
+                }
+                return true;
+            }
+        };
+    };
+
+    typedef chashtable<entry*, entry::hash_proc, entry::eq_proc> entry_table;
+
+    manager &   m_upm;
+    unsigned    m_max_size;
+    entry_table m_table;
+    unsigned    m_hits;
+    unsigned    m_misses;
+
+    imp(manager & upm, unsigned max_size):
+        m_upm(upm),
+        m_max_size(max_size),
+        m_table(entry::hash_proc(), entry::eq_proc(upm.m())),
+        m_hits(0),
+        m_misses(0) {
+    }
+
+    ~imp() {
+        reset();
+    }
+
+    void del_entry(entry * e) {
+        m_upm.reset(e->m_p);
+        dealloc(e->m_factors);
+        dealloc(e);
+    }
+
+    void reset() {
+        entry_table::iterator it  = m_table.begin();
+        entry_table::iterator end = m_table.end();
+        for (; it != end; ++it) {
+            del_entry(*it);
+        }
+        m_table.reset();
+    }
+
+    static void copy(factors const & src, factors & dst) {
+        dst.set_constant(src.get_constant());
+        for (unsigned i = 0; i < src.distinct_factors(); ++ i) {
+            dst.push_back(src[i], src.get_degree(i));
+        }
+    }
+
+    bool factor(unsigned sz, numeral const * p, factors & r, factor_params const & params) {
+        SASSERT(!m_upm.m().modular());
+        SASSERT(r.distinct_factors() == 0);
+        entry * e = alloc(entry);
+        m_upm.set(sz, p, e->m_p);
+        e->m_hash = sz;
+        for (unsigned i = 0; i < sz; ++ i) {
+            e->m_hash = combine_hash(e->m_hash, unsynch_mpz_manager::hash(p[i]));
+        }
+        entry * old_e = 0;
+        if (m_table.find(e, old_e)) {
+            del_entry(e);
+            m_hits++;
+            copy(*(old_e->m_factors), r);
+            return old_e->m_full;
+        }
+        m_misses++;
+        e->m_factors = alloc(factors, m_upm);
+        try {
+            e->m_full = m_upm.factor(sz, p, *(e->m_factors), params);
+        }
+        catch (...) {
+            del_entry(e);
+            throw;
+        }
+        if (m_table.size() >= m_max_size)
+            reset();
+        m_table.insert(e);
+        copy(*(e->m_factors), r);
+        return e->m_full;
+    }
+};
+
+factorization_cache::factorization_cache(manager & upm, unsigned max_size) {
+    m_imp = alloc(imp, upm, max_size);
+}
+
+factorization_cache::~factorization_cache() {
+    dealloc(m_imp);
+}
+
+bool factorization_cache::factor(unsigned sz, numeral const * p, factors & r, factor_params const & params) {
+    return m_imp->factor(sz, p, r, params);
+}
+
+unsigned factorization_cache::size() const {
+    return m_imp->m_table.size();
+}
+
+unsigned factorization_cache::hits() const {
+    return m_imp->m_hits;
+}
+
+unsigned factorization_cache::misses() const {
+    return m_imp->m_misses;
+}
+
+void factorization_cache::reset_statistics() {
+    m_imp->m_hits   = 0;
+    m_imp->m_misses = 0;
+}
+
+void factorization_cache::reset() {
+    m_imp->reset();
+}
+
 }; // end upolynomial namespace
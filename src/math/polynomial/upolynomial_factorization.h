@@ -91,6 +91,33 @@ namespace upolynomial {
        That is, the factors of f are inserted as factors of degree k into fs.
     */
     bool factor_square_free(z_manager & upm, numeral_vector const & f, factors & fs, unsigned k, factor_params const & ps = factor_params());
+
+    /**
+       \brief Cache for the factorizations of polynomials in Z[x] computed by manager::factor.
+       The same polynomials are usually factored over and over again by clients such as the algebraic number package.
+       The cache is flushed when it contains more than max_size polynomials.
+
+       \remark The result of factor depends on the factor_params, so the cache must be reset if they change.
+    */
+    class factorization_cache {
+        struct imp;
+        imp * m_imp;
+    public:
+        factorization_cache(manager & upm, unsigned max_size = 1024);
+        ~factorization_cache();
+        /**
+           \brief Same as manager::factor, but the result is cached.
+        */
+        bool factor(unsigned sz, numeral const * p, factors & r, factor_params const & params = factor_params());
+        bool factor(numeral_vector const & p, factors & r, factor_params const & params = factor_params()) {
+            return factor(p.size(), p.c_ptr(), r, params);
+        }
+        unsigned size() const;
+        unsigned hits() const;
+        unsigned misses() const;
+        void reset_statistics();
+        void reset();
+    };
 };
 
 #endif
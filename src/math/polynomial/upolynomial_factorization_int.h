@@ -385,6 +385,51 @@ namespace upolynomial {
             }
         }
 
+        /**
+           \brief Store in out m times the sum of the coefficients of x^{d-1} of the current selection, where d is
+           the degree of each factor. Since the factors are monic, it is the coefficient of x^{D-1} in m times
+           their product, where D is the degree of the product.
+        */
+        void get_left_trace_coeff(numeral const & m, numeral & out) {
+            zp_numeral_manager &  nm = m_factors.upm().m();
+            nm.set(out, 0);
+            for (int i = 0; i < m_current_size; ++ i) {
+                numeral_vector const & f = m_factors[m_current[i]];
+                SASSERT(f.size() >= 2);
+                nm.add(out, f[f.size() - 2], out);
+            }
+            nm.mul(out, m, out);
+        }
+
+        /**
+           \brief Same as get_left_trace_coeff, but for the factors that are not in the current selection.
+        */
+        void get_right_trace_coeff(numeral const & m, numeral & out) {
+            zp_numeral_manager &  nm = m_factors.upm().m();
+            nm.set(out, 0);
+
+            unsigned current = 0;
+            unsigned selection_i = 0;
+
+            // selection is ordered, so we just take the ones in between that are not disable
+            while (current <  m_factors.distinct_factors()) {
+                if (!m_enabled[current]) {
+                    current ++;
+                } else {
+                    if (selection_i >= m_current.size() || (int) current < m_current[selection_i]) {
+                        numeral_vector const & f = m_factors[current];
+                        SASSERT(f.size() >= 2);
+                        nm.add(out, f[f.size() - 2], out);
+                        current ++;
+                    } else {
+                        current ++;
+                        selection_i ++;
+                    }
+                }
+            }
+            nm.mul(out, m, out);
+        }
+
         void right(numeral_vector & out) const {
             SASSERT(m_current_size > 0);
             zp_manager & upm = m_factors.upm();
@@ -294,6 +294,10 @@ namespace datalog {
     unsigned context::similarity_compressor_threshold() const { return m_params->datalog_similarity_compressor_threshold(); }
     unsigned context::soft_timeout() const { return m_fparams.m_timeout; }
     unsigned context::initial_restart_timeout() const { return m_params->datalog_initial_restart_timeout(); } 
+    bool context::incremental() const { return m_params->datalog_incremental(); }
+    unsigned context::mapped_table_spill_rows() const { return m_params->datalog_mapped_table_spill_rows(); }
+    bool context::profile_joins() const { return m_params->datalog_profile_joins(); }
+    symbol context::cardinality_profile() const { return m_params->datalog_cardinality_profile(); }
     bool context::generate_explanations() const { return m_params->datalog_generate_explanations(); }
     bool context::explanations_on_relation_level() const { return m_params->datalog_explanations_on_relation_level(); }
     bool context::magic_sets_for_queries() const { return m_params->datalog_magic_sets_for_queries();  }
@@ -662,6 +666,14 @@ namespace datalog {
         add_table_fact(pred, fact);
     }
 
+    void context::load_table_facts(func_decl * pred, char const * file_name) {
+        if (get_engine() != DATALOG_ENGINE) {
+            throw default_exception("table files can only be loaded by the datalog engine");
+        }
+        ensure_engine();
+        m_rel->load_table_facts(pred, file_name);
+    }
+
     void context::close() {
         SASSERT(!m_closed);
         if (!m_rule_set.close()) {
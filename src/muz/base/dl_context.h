@@ -124,6 +124,7 @@ namespace datalog {
         virtual bool result_contains_fact(relation_fact const& f) = 0;
         virtual void add_fact(func_decl* pred, relation_fact const& fact) = 0;
         virtual void add_fact(func_decl* pred, table_fact const& fact) = 0;
+        virtual void load_table_facts(func_decl* pred, char const* file_name) = 0;
         virtual bool has_facts(func_decl * pred) const = 0;
         virtual void store_relation(func_decl * pred, relation_base * rel) = 0;
         virtual void inherit_predicate_kind(func_decl* new_pred, func_decl* orig_pred) = 0;
@@ -237,6 +238,7 @@ namespace datalog {
         rule_manager & get_rule_manager() { return m_rule_manager; }
         smt_params & get_fparams() const { return m_fparams; }
         fixedpoint_params const&  get_params() const { return *m_params; }
+        params_ref const&         get_params_ref() const { return m_params_ref; }
         DL_ENGINE get_engine() { configure_engine(); return m_engine_type; }
         register_engine_base& get_register_engine() { return m_register_engine; }
         th_rewriter& get_rewriter() { return m_rewriter; }
@@ -266,6 +268,10 @@ namespace datalog {
         unsigned similarity_compressor_threshold() const;
         unsigned soft_timeout() const;
         unsigned initial_restart_timeout() const;
+        bool incremental() const;
+        unsigned mapped_table_spill_rows() const;
+        bool profile_joins() const;
+        symbol cardinality_profile() const;
         bool generate_explanations() const;
         bool explanations_on_relation_level() const;
         bool magic_sets_for_queries() const;
@@ -441,6 +447,12 @@ namespace datalog {
         void add_table_fact(func_decl * pred, const table_fact & fact);
         void add_table_fact(func_decl * pred, unsigned num_args, unsigned args[]);
 
+        /**
+           \brief Add to \c pred the facts stored in the binary table file \c file_name
+           (see mapped_table::load). Only supported by the datalog engine.
+        */
+        void load_table_facts(func_decl * pred, char const * file_name);
+
         /**
            \brief To be called after all rules are added.
         */
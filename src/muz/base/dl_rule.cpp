@@ -50,6 +50,7 @@ namespace datalog {
     rule_manager::rule_manager(context& ctx) 
         : m(ctx.get_manager()),
           m_ctx(ctx),
+          m_used(true),
           m_body(m),
           m_head(m),
           m_args(m),
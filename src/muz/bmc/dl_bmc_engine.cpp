@@ -32,6 +32,10 @@ Revision History:
 #include "dl_transforms.h"
 #include "dl_mk_rule_inliner.h"
 #include "scoped_proof.h"
+#include "ast_translation.h"
+#include "scoped_ptr_vector.h"
+#include "fixedpoint_params.hpp"
+#include "z3_omp.h"
 
 namespace datalog {
 
@@ -1153,19 +1157,56 @@ namespace datalog {
         linear(bmc& b): b(b), m(b.m) {}
 
         lbool check() {
+            return search(0, 1, 0, 0);
+        }
+
+        /**
+           \brief Unfold the rules one level at a time into the same solver, and check
+           the levels first, first + step, first + 2*step, ... by assuming the query
+           predicate of the level. If \c stop is given, the level being checked is
+           stored in \c level, a counterexample lowers \c stop to its level instead of 
+           producing a certificate, and the search gives up (returning l_undef) once 
+           \c stop is not larger than the current level.
+        */
+        lbool search(unsigned first, unsigned step, unsigned volatile* stop, unsigned volatile* level) {
             setup();
             for (unsigned i = 0; ; ++i) {
-                IF_VERBOSE(1, verbose_stream() << "level: " << i << "\n";);
                 b.checkpoint();
                 compile(i);
+                if (i < first || (i - first) % step != 0) {
+                    continue;
+                }
+                if (stop) {
+                    bool give_up;
+                    #pragma omp critical (bmc_parallel)
+                    {
+                        *level = i;
+                        give_up = *stop <= i;
+                    }
+                    if (give_up) {
+                        return l_undef;
+                    }
+                }
+                IF_VERBOSE(1, verbose_stream() << "level: " << i << "\n";);
                 lbool res = check(i);
                 if (res == l_undef) {
                     return res;
                 }
                 if (res == l_true) {
-                    get_model(i);
+                    if (stop) {
+                        #pragma omp critical (bmc_parallel)
+                        {
+                            if (i < *stop) *stop = i;
+                        }
+                    }
+                    else {
+                        get_model(i);
+                    }
                     return res;
                 }
+                // the query is unreachable at this level, keep it as a fact for deeper levels.
+                expr_ref level_query = mk_level_predicate(b.m_query_pred, i);
+                b.assert_expr(m.mk_not(level_query));
             }
         }
 
@@ -1419,6 +1460,130 @@ namespace datalog {
         }
     };
 
+    class null_register_engine : public register_engine_base {
+    public:
+        virtual engine_base* mk_engine(DL_ENGINE engine_type) { return 0; }
+        virtual void set_context(context* ctx) {}
+    };
+
+    /**
+       \brief Engine of a helper thread of a parallel BMC run, with its own copy of the
+       manager, the parameters and the rules.
+    */
+    struct bmc::worker {
+        ast_manager          m;
+        smt_params           m_fparams;
+        null_register_engine m_register_engine;
+        context              m_ctx;
+        bmc                  m_bmc;
+        unsigned volatile    m_level;       // level being checked.
+        lbool                m_result;
+        bool                 m_has_error;
+        unsigned             m_error_code;
+        std::string          m_msg;         // message of an exception, if any.
+        worker(ast_manager& m0, smt_params const& fparams, params_ref const& p):
+            m(m0, true),
+            m_fparams(fparams),
+            m_ctx(m, m_register_engine, m_fparams, p),
+            m_bmc(m_ctx),
+            m_level(0),
+            m_result(l_undef),
+            m_has_error(false),
+            m_error_code(0) {}
+    };
+
+    //
+    // Thread i of n checks the depths i, i + n, i + 2n, ... of the unfolding of the
+    // rules, each thread with its own manager and incremental solver. Once a thread
+    // finds a counterexample, the threads checking deeper levels are canceled, while
+    // the others finish the levels below it. The main solver then checks the lowest
+    // level with a counterexample again to produce the certificate.
+    // 
+    lbool bmc::check_linear_parallel(unsigned num_threads) {
+#ifdef _NO_OMP_
+        linear lin(*this);
+        return lin.check();
+#else
+        if (omp_in_parallel()) {
+            linear lin(*this);
+            return lin.check();
+        }
+        scoped_ptr_vector<worker> workers;
+        for (unsigned i = 0; i < num_threads; ++i) {
+            worker* w = alloc(worker, m, m_ctx.get_fparams(), m_ctx.get_params_ref());
+            workers.push_back(w);
+            ast_translation tr(m, w->m);
+            rule_manager& rm = w->m_ctx.get_rule_manager();
+            rule_set::iterator it = m_rules.begin(), end = m_rules.end();
+            for (; it != end; ++it) {
+                rule& r = **it;
+                app_ref_vector tail(w->m);
+                svector<bool> is_neg;
+                for (unsigned j = 0; j < r.get_tail_size(); ++j) {
+                    tail.push_back(tr(r.get_tail(j)));
+                    is_neg.push_back(r.is_neg_tail(j));
+                }
+                app_ref head(tr(r.get_head()), w->m);
+                w->m_bmc.m_rules.add_rule(rm.mk(head, tail.size(), tail.c_ptr(), is_neg.c_ptr(), r.name(), false));
+            }
+            w->m_bmc.m_rules.close();
+            w->m_bmc.m_query_pred = tr(m_query_pred.get());
+            m.limit().push_child(&w->m.limit());
+        }
+
+        unsigned volatile found = UINT_MAX;
+
+        #pragma omp parallel for num_threads(num_threads)
+        for (int i = 0; i < static_cast<int>(num_threads); ++i) {
+            worker& w = *workers[i];
+            try {
+                linear lin(w.m_bmc);
+                w.m_result = lin.search(i, num_threads, &found, &w.m_level);
+                if (w.m_result == l_true) {
+                    #pragma omp critical (bmc_parallel)
+                    {
+                        for (unsigned j = 0; j < workers.size(); ++j) {
+                            if (workers[j]->m_level > found) {
+                                workers[j]->m.limit().cancel();
+                            }
+                        }
+                    }
+                }
+            }
+            catch (z3_error & err) {
+                w.m_has_error = true;
+                w.m_error_code = err.error_code();
+            }
+            catch (z3_exception & ex) {
+                w.m_msg = ex.msg();
+            }
+        }
+
+        for (unsigned i = 0; i < workers.size(); ++i) {
+            m.limit().pop_child();
+        }
+        // a thread that stopped below the counterexample leaves levels unchecked.
+        for (unsigned i = 0; i < workers.size(); ++i) {
+            worker& w = *workers[i];
+            if (w.m_result == l_true || w.m_level >= found) {
+                continue;
+            }
+            if (w.m_has_error) {
+                throw z3_error(w.m_error_code);
+            }
+            if (!w.m_msg.empty()) {
+                throw default_exception(w.m_msg.c_str());
+            }
+            return l_undef;
+        }
+        if (found != UINT_MAX) {
+            linear lin(*this);
+            return lin.search(found, 1, 0, 0);
+        }
+        return l_undef;
+#endif
+    }
+
     bmc::bmc(context& ctx):
         engine_base(ctx.get_manager(), "bmc"),
         m_ctx(ctx),
@@ -1478,6 +1643,9 @@ namespace datalog {
                 qlinear ql(*this);
                 return ql.check();
             }
+            else if (m_ctx.get_params().bmc_threads() > 1) {
+                return check_linear_parallel(m_ctx.get_params().bmc_threads());
+            }
             else {
                 linear lin(*this);
                 return lin.check();
@@ -45,8 +45,11 @@ namespace datalog {
         class nonlinear;
         class qlinear;
         class linear;
+        struct worker;
 
         bool is_linear() const;
+
+        lbool check_linear_parallel(unsigned num_threads);
         
         void assert_expr(expr* e);
 
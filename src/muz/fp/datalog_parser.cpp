@@ -1257,6 +1257,14 @@ private:
             }
             parse_rel_file(rel_file_name);
         }
+
+        string_vector bin_files;
+        get_file_names(path, "bin", true, bin_files);
+        string_vector::iterator bit = bin_files.begin();
+        string_vector::iterator bend = bin_files.end();
+        for(; bit!=bend; ++bit) {
+            load_bin_file(*bit);
+        }
         IF_VERBOSE(10, verbose_stream() << "Done parsing directory " << path << "\n";);
         return true;
     }
@@ -1404,6 +1412,26 @@ private:
         }
     }
 
+    /**
+       \brief Load a binary table file. Its values are table elements, not the numbers 
+       of the map files, so they are not translated.
+    */
+    void load_bin_file(std::string fname) {
+        SASSERT(file_exists(fname));
+
+        IF_VERBOSE(10, verbose_stream() << "Loading table file " << fname << "\n";);
+
+        std::string predicate_name_str = get_file_name_without_extension(fname);
+        symbol predicate_name(predicate_name_str.c_str());
+
+        func_decl * pred = m_context.try_get_predicate_decl(predicate_name);
+        if(!pred) {
+            throw default_exception(default_exception::fmt(), "table file %s for undeclared predicate %s", 
+                fname.c_str(), predicate_name.bare_str());
+        }
+        m_context.load_table_facts(pred, fname.c_str());
+    }
+
     void finish_map_files() {
 
         m_bool_sort = register_finite_sort(symbol("BOOL"), 2, context::SK_UINT64);
@@ -50,6 +50,7 @@ Notes:
 #include "model_implicant.h"
 #include "expr_safe_replace.h"
 #include "ast_util.h"
+#include "ast_translation.h"
 
 namespace pdr {
 
@@ -60,6 +61,8 @@ namespace pdr {
 
     static unsigned next_level(unsigned lvl) { return is_infty_level(lvl)?lvl:(lvl+1); }
 
+    static const unsigned max_inductive_cache_size = 10000;
+
     struct pp_level {
         unsigned m_level;
         pp_level(unsigned l): m_level(l) {}
@@ -82,7 +85,8 @@ namespace pdr {
         ctx(ctx), m_head(head, m),
         m_sig(m), m_solver(pm, head->get_name()),
         m_invariants(m), m_transition(m), m_initial_state(m),
-        m_reachable(pm, (datalog::PDR_CACHE_MODE)ctx.get_params().pdr_cache_mode()) {}
+        m_reachable(pm, (datalog::PDR_CACHE_MODE)ctx.get_params().pdr_cache_mode()),
+        m_cache_refs(m), m_failure_refs(m), m_indexed_props(m) {}
 
     pred_transformer::~pred_transformer() {
         rule2inst::iterator it2 = m_rule2inst.begin(), end2 = m_rule2inst.end();
@@ -109,6 +113,8 @@ namespace pdr {
         m_solver.collect_statistics(st);
         m_reachable.collect_statistics(st);
         st.update("PDR num propagations", m_stats.m_num_propagations);
+        st.update("PDR num cached checks", m_stats.m_num_cache_hits);
+        st.update("PDR num subsumed properties", m_stats.m_num_subsumed);
         unsigned np = m_invariants.size();
         for (unsigned i = 0; i < m_levels.size(); ++i) {
             np += m_levels[i].size();
@@ -139,6 +145,10 @@ namespace pdr {
         if (is_infty_level(level)) {
             return;
         }
+        if (m_levels.size() <= level) {
+            // cores cached for the old frontier are rarely asked for again.
+            reset_inductive_cache();
+        }
         while (m_levels.size() <= level) {
             m_solver.add_level();
             m_levels.push_back(expr_ref_vector(m));
@@ -274,15 +284,26 @@ namespace pdr {
 
         for (unsigned i = 0; i < src.size(); ) {
             expr * curr = src[i].get();
-            unsigned stored_lvl;
-            VERIFY(m_prop2level.find(curr, stored_lvl));
-            SASSERT(stored_lvl >= src_level);
+            unsigned stored_lvl = 0, failed_lvl;
+            bool indexed = m_prop2level.find(curr, stored_lvl);
+            SASSERT(!indexed || stored_lvl >= src_level);
             bool assumes_level;
-            if (stored_lvl > src_level) {
+            if (!indexed) {
+                // subsumed by a property of a higher level.
+                TRACE("pdr", tout << "subsumed: " << mk_pp(curr, m) << "\n";);
+                src[i] = src.back();
+                src.pop_back();
+            }
+            else if (stored_lvl > src_level) {
                 TRACE("pdr", tout << "at level: "<< stored_lvl << " " << mk_pp(curr, m) << "\n";);
                 src[i] = src.back();
                 src.pop_back();
             }
+            else if (m_propagation_failures.find(curr, failed_lvl) && failed_lvl == tgt_level) {
+                // nothing changed since it last failed to propagate.
+                ++m_stats.m_num_cache_hits;
+                ++i;
+            }
             else if (is_invariant(tgt_level, curr, false, assumes_level)) {
 
                 add_property(curr, assumes_level?tgt_level:infty_level);
@@ -293,6 +314,10 @@ namespace pdr {
             }
             else {
                 TRACE("pdr", tout << "not propagated: " << mk_pp(curr, m) << "\n";);
+                if (ctx.get_params().pdr_cache_checks()) {
+                    m_failure_refs.push_back(curr);
+                    m_propagation_failures.insert(curr, tgt_level);
+                }
                 ++i;
             }
         }
@@ -304,12 +329,24 @@ namespace pdr {
     }
 
     bool pred_transformer::add_property1(expr * lemma, unsigned lvl) {
+        if (ctx.get_params().pdr_cache_checks() && is_subsumed(lemma, lvl)) {
+            TRACE("pdr", tout << "subsumed: " << pp_level(lvl) << " " << mk_pp(lemma, m) << "\n";);
+            ++m_stats.m_num_subsumed;
+            unsigned old_level;
+            if (m_prop2level.find(lemma, old_level) && old_level < lvl) {
+                // the subsuming property also holds at the old level.
+                unindex_property(lemma);
+            }
+            return false;
+        }
         if (is_infty_level(lvl)) {
             if (!m_invariants.contains(lemma)) {
                 TRACE("pdr", tout << "property1: " << head()->get_name() << " " << mk_pp(lemma, m) << "\n";);
                 m_invariants.push_back(lemma);
                 m_prop2level.insert(lemma, lvl);
                 m_solver.add_formula(lemma);
+                solver_updated();
+                index_property(lemma, lvl);
                 return true;
             }
             else {
@@ -324,6 +361,8 @@ namespace pdr {
             m_levels[lvl].push_back(lemma);
             m_prop2level.insert(lemma, lvl);
             m_solver.add_level_formula(lemma, lvl);
+            solver_updated();
+            index_property(lemma, lvl);
             return true;
         }
         else {
@@ -344,6 +383,128 @@ namespace pdr {
             else {
                 m_solver.add_level_formula(fmls[i].get(), lvl);
             }
+            solver_updated();
+        }
+    }
+
+    /**
+       \brief The solver has new constraints: checks that failed may succeed now.
+    */
+    void pred_transformer::solver_updated() {
+        m_inductive_failures.reset();
+        m_propagation_failures.reset();
+        m_failure_refs.reset();
+    }
+
+    void pred_transformer::reset_inductive_cache() {
+        m_inductive_cache.reset();
+        m_cache_refs.reset();
+    }
+
+    expr* pred_transformer::mk_cube_key(expr_ref_vector const& lits, expr_ref_vector& refs) {
+        ptr_vector<expr> args(lits.size(), lits.c_ptr());
+        std::sort(args.begin(), args.end(), ast_lt_proc());
+        expr* key;
+        switch (args.size()) {
+        case 0: key = m.mk_true(); break;
+        case 1: key = args[0]; break;
+        default: key = m.mk_and(args.size(), args.c_ptr()); break;
+        }
+        refs.push_back(key);
+        return key;
+    }
+
+    /**
+       \brief Check if a property of level \c lvl or higher is a sub-clause of \c lemma.
+    */
+    bool pred_transformer::is_subsumed(expr* lemma, unsigned lvl) {
+        expr_ref_vector lits(m), lits2(m);
+        pm.get_or(lemma, lits);
+        obj_hashtable<expr> lit_set;
+        for (unsigned i = 0; i < lits.size(); ++i) {
+            lit_set.insert(lits[i].get());
+        }
+        for (unsigned i = 0; i < lits.size(); ++i) {
+            ptr_vector<expr> const* props = m_lit2props.find_core(lits[i].get()) ? 
+                &m_lit2props.find_core(lits[i].get())->get_data().m_value : 0;
+            for (unsigned j = 0; props && j < props->size(); ++j) {
+                expr* p = (*props)[j];
+                unsigned p_lvl;
+                if (p == lemma || !m_prop2level.find(p, p_lvl) || p_lvl < lvl) {
+                    continue;
+                }
+                lits2.reset();
+                pm.get_or(p, lits2);
+                bool sub = lits2.size() <= lits.size();
+                for (unsigned k = 0; sub && k < lits2.size(); ++k) {
+                    sub = lit_set.contains(lits2[k].get());
+                }
+                if (sub) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+       \brief Index a new property. The properties of lower levels it subsumes are removed
+       from the index, so that propagation drops them instead of checking them again.
+    */
+    void pred_transformer::index_property(expr* lemma, unsigned lvl) {
+        if (!ctx.get_params().pdr_cache_checks()) {
+            return;
+        }
+        expr_ref_vector lits(m), lits2(m);
+        pm.get_or(lemma, lits);
+        m_indexed_props.push_back(lemma);
+        ptr_vector<expr> const* props = m_lit2props.find_core(lits[0].get()) ? 
+            &m_lit2props.find_core(lits[0].get())->get_data().m_value : 0;
+        ptr_vector<expr> subsumed;
+        for (unsigned j = 0; props && j < props->size(); ++j) {
+            expr* p = (*props)[j];
+            unsigned p_lvl;
+            if (p == lemma || !m_prop2level.find(p, p_lvl) || is_infty_level(p_lvl) ||
+                (!is_infty_level(lvl) && p_lvl >= lvl)) {
+                continue;
+            }
+            lits2.reset();
+            pm.get_or(p, lits2);
+            obj_hashtable<expr> lit_set;
+            for (unsigned k = 0; k < lits2.size(); ++k) {
+                lit_set.insert(lits2[k].get());
+            }
+            bool sub = lits.size() <= lits2.size();
+            for (unsigned k = 0; sub && k < lits.size(); ++k) {
+                sub = lit_set.contains(lits[k].get());
+            }
+            if (sub) {
+                subsumed.push_back(p);
+            }
+        }
+        for (unsigned j = 0; j < subsumed.size(); ++j) {
+            unindex_property(subsumed[j]);
+            ++m_stats.m_num_subsumed;
+        }
+        for (unsigned i = 0; i < lits.size(); ++i) {
+            m_lit2props.insert_if_not_there2(lits[i].get(), ptr_vector<expr>())->get_data().m_value.push_back(lemma);
+        }
+    }
+
+    /**
+       \brief Remove a subsumed property from the index. 
+       It stays in its level until propagation drops it.
+    */
+    void pred_transformer::unindex_property(expr* p) {
+        m_prop2level.erase(p);
+        m_propagation_failures.erase(p);
+        expr_ref_vector lits(m);
+        pm.get_or(p, lits);
+        for (unsigned i = 0; i < lits.size(); ++i) {
+            obj_map<expr, ptr_vector<expr> >::obj_map_entry* e = m_lit2props.find_core(lits[i].get());
+            if (e) {
+                e->get_data().m_value.erase(p);
+            }
         }
     }
 
@@ -354,6 +515,7 @@ namespace pdr {
             expr* lemma_i = lemmas[i].get();
             if (add_property1(lemma_i, lvl)) {
                 IF_VERBOSE(2, verbose_stream() << pp_level(lvl) << " " << mk_pp(lemma_i, m) << "\n";);
+                ctx.export_lemma(head(), lemma_i, lvl);
                 for (unsigned j = 0; j < m_use.size(); ++j) {
                     m_use[j]->add_child_property(*this, lemma_i, next_level(lvl));
                 }
@@ -473,6 +635,49 @@ namespace pdr {
     }
 
     bool pred_transformer::check_inductive(unsigned level, expr_ref_vector& lits, bool& assumes_level) {
+        bool use_cache = ctx.get_params().pdr_cache_checks();
+        expr* key = 0;
+        if (use_cache) {
+            key = mk_cube_key(lits, m_cache_refs);
+            inductive_check c;
+            unsigned failed_level;
+            if (m_inductive_cache.find(key, c) && (level <= c.m_level || !c.m_assumes_level)) {
+                ++m_stats.m_num_cache_hits;
+                lits.reset();
+                flatten_and(c.m_core, lits);
+                assumes_level = c.m_assumes_level;
+                m_cache_refs.pop_back();
+                return true;
+            }
+            if (m_inductive_failures.find(key, failed_level) && failed_level <= level) {
+                ++m_stats.m_num_cache_hits;
+                m_cache_refs.pop_back();
+                return false;
+            }
+        }
+        bool result = check_inductive_core(level, lits, assumes_level);
+        if (!use_cache) {
+            return result;
+        }
+        if (result) {
+            inductive_check c;
+            c.m_level = level;
+            c.m_assumes_level = assumes_level;
+            c.m_core = mk_cube_key(lits, m_cache_refs);
+            m_inductive_cache.insert(key, c);
+            if (m_inductive_cache.size() > max_inductive_cache_size) {
+                reset_inductive_cache();
+            }
+        }
+        else {
+            m_failure_refs.push_back(key);
+            m_cache_refs.pop_back();
+            m_inductive_failures.insert(key, level);
+        }
+        return result;
+    }
+
+    bool pred_transformer::check_inductive_core(unsigned level, expr_ref_vector& lits, bool& assumes_level) {
         manager& pm = get_pdr_manager();
         expr_ref_vector conj(m), core(m);
         expr_ref fml(m), states(m);
@@ -1450,7 +1655,11 @@ namespace pdr {
           m_search(m_params.pdr_bfs_model_search()),
           m_last_result(l_undef),
           m_inductive_lvl(0),
-          m_expanded_lvl(0)
+          m_expanded_lvl(0),
+          m_exchange(0),
+          m_worker_id(0),
+          m_exchange_head(0),
+          m_importing(false)
     {
     }
 
@@ -1914,6 +2123,78 @@ namespace pdr {
         }
     }
 
+    void context::set_lemma_exchange(lemma_exchange* e, unsigned worker_id) {
+        m_exchange = e;
+        m_worker_id = worker_id;
+        m_exchange_head = 0;
+    }
+
+    void context::export_lemma(func_decl* pred, expr* lemma, unsigned lvl) {
+        if (m_exchange && !m_importing) {
+            m_exchange->publish(m_worker_id, m, pred, lemma, lvl);
+            ++m_stats.m_num_exported;
+        }
+    }
+
+    /**
+       \brief Add the lemmas that the other contexts of a parallel run found since the last call.
+       The frames of all contexts over-approximate the states reachable within the same number 
+       of steps, so a lemma of any context holds at the same level in this one.
+    */
+    void context::import_lemmas() {
+        if (!m_exchange) {
+            return;
+        }
+        func_decl_ref_vector preds(m);
+        expr_ref_vector lemmas(m);
+        unsigned_vector levels;
+        m_exchange_head = m_exchange->fetch(m_worker_id, m_exchange_head, m, preds, lemmas, levels);
+        flet<bool> _importing(m_importing, true);
+        for (unsigned i = 0; i < lemmas.size(); ++i) {
+            pred_transformer* pt;
+            if (m_rels.find(preds[i].get(), pt)) {
+                TRACE("pdr", tout << "import " << pp_level(levels[i]) << " " << mk_pp(lemmas[i].get(), m) << "\n";);
+                pt->add_property(lemmas[i].get(), levels[i]);
+                ++m_stats.m_num_imported;
+            }
+        }
+    }
+
+    lemma_exchange::lemma_exchange(ast_manager& m0):
+        m(m0, true),
+        m_preds(m),
+        m_lemmas(m) {
+    }
+
+    void lemma_exchange::publish(unsigned owner, ast_manager& src, func_decl* pred, expr* lemma, unsigned lvl) {
+        #pragma omp critical (pdr_lemma_exchange)
+        {
+            ast_translation tr(src, m, false);
+            m_preds.push_back(tr(pred));
+            m_lemmas.push_back(tr(lemma));
+            m_levels.push_back(lvl);
+            m_owners.push_back(owner);
+        }
+    }
+
+    unsigned lemma_exchange::fetch(unsigned owner, unsigned head, ast_manager& dst, func_decl_ref_vector& preds, 
+                                   expr_ref_vector& lemmas, unsigned_vector& levels) {
+        unsigned result;
+        #pragma omp critical (pdr_lemma_exchange)
+        {
+            ast_translation tr(m, dst, false);
+            for (unsigned i = head; i < m_lemmas.size(); ++i) {
+                if (m_owners[i] != owner) {
+                    preds.push_back(tr(m_preds.get(i)));
+                    lemmas.push_back(tr(m_lemmas.get(i)));
+                    levels.push_back(m_levels[i]);
+                }
+            }
+            result = m_lemmas.size();
+        }
+        return result;
+    }
+
     /**
        \brief retrieve answer.
     */
@@ -1977,6 +2258,7 @@ namespace pdr {
         bool reachable;
         while (true) {
             checkpoint();
+            import_lemmas();
             m_expanded_lvl = lvl;
             reachable = check_reachability(lvl);
             if (reachable) {
@@ -2007,6 +2289,7 @@ namespace pdr {
         while (model_node* node = m_search.next()) {
             IF_VERBOSE(2, verbose_stream() << "Expand node: " << node->level() << "\n";);
             checkpoint();
+            import_lemmas();
             expand_node(*node);
         }
         return root->is_closed();
@@ -2306,6 +2589,10 @@ namespace pdr {
         st.update("PDR num unfoldings", m_stats.m_num_nodes);
         st.update("PDR max depth", m_stats.m_max_depth);
         st.update("PDR inductive level", m_inductive_lvl);
+        if (m_stats.m_num_imported + m_stats.m_num_exported > 0) {
+            st.update("PDR num imported lemmas", m_stats.m_num_imported);
+            st.update("PDR num exported lemmas", m_stats.m_num_exported);
+        }
         m_pm.collect_statistics(st);
 
         for (unsigned i = 0; i < m_core_generalizers.size(); ++i) {
@@ -56,10 +56,22 @@ namespace pdr {
 
         struct stats {
             unsigned m_num_propagations;
+            unsigned m_num_cache_hits;
+            unsigned m_num_subsumed;
             stats() { reset(); }
             void reset() { memset(this, 0, sizeof(*this)); }
         };
 
+        /**
+           A cube shown inductive relative to a level. The check also succeeds at 
+           every lower level, since the lower levels have more lemmas.
+        */
+        struct inductive_check {
+            unsigned m_level;
+            bool     m_assumes_level;
+            expr*    m_core;            // conjunction of the core of the check.
+        };
+
         typedef obj_map<datalog::rule const, expr*> rule2expr;
         typedef obj_map<datalog::rule const, ptr_vector<app> > rule2apps;
 
@@ -86,12 +98,28 @@ namespace pdr {
         ptr_vector<func_decl>        m_predicates;
         stats                        m_stats;
 
+        // caches that avoid repeating checks of m_solver.
+        expr_ref_vector              m_cache_refs;
+        obj_map<expr, inductive_check> m_inductive_cache;        // cube -> highest level where it is inductive.
+        expr_ref_vector              m_failure_refs;
+        obj_map<expr, unsigned>      m_inductive_failures;       // cube -> lowest level where it is not inductive.
+        obj_map<expr, unsigned>      m_propagation_failures;     // property -> level it failed to propagate to.
+        obj_map<expr, ptr_vector<expr> > m_lit2props;            // literal -> properties that contain it.
+        expr_ref_vector              m_indexed_props;
+
         void init_sig();
         void ensure_level(unsigned level);
         bool add_property1(expr * lemma, unsigned lvl);  // add property 'p' to state at level lvl.
         void add_child_property(pred_transformer& child, expr* lemma, unsigned lvl); 
         void mk_assumptions(func_decl* head, expr* fml, expr_ref_vector& result);
 
+        void solver_updated();
+        void reset_inductive_cache();
+        expr* mk_cube_key(expr_ref_vector const& lits, expr_ref_vector& refs);
+        bool is_subsumed(expr* lemma, unsigned lvl);
+        void index_property(expr* lemma, unsigned lvl);
+        void unindex_property(expr* p);
+
         // Initialization
         void init_rules(decl2rel const& pts, expr_ref& init, expr_ref& transition);
         void init_rule(decl2rel const& pts, datalog::rule const& rule, expr_ref& init,                                      
@@ -145,6 +173,7 @@ namespace pdr {
         lbool is_reachable(model_node& n, expr_ref_vector* core, bool& uses_level);
         bool is_invariant(unsigned level, expr* co_state, bool inductive, bool& assumes_level, expr_ref_vector* core = 0);
         bool check_inductive(unsigned level, expr_ref_vector& state, bool& assumes_level);
+        bool check_inductive_core(unsigned level, expr_ref_vector& state, bool& assumes_level);
 
         expr_ref get_formulas(unsigned level, bool add_axioms);
 
@@ -313,11 +342,43 @@ namespace pdr {
         virtual void reset_statistics() {}
     };
 
+    /**
+       \brief Lemmas found by the contexts of a parallel PDR run.
+
+       Every context of the run has its own ast_manager. The lemmas are kept in 
+       terms of a separate manager, and all accesses are serialized, so that contexts
+       running in different threads can exchange them.
+    */
+    class lemma_exchange {
+        ast_manager          m;
+        func_decl_ref_vector m_preds;
+        expr_ref_vector      m_lemmas;
+        unsigned_vector      m_levels;
+        unsigned_vector      m_owners;
+    public:
+        lemma_exchange(ast_manager& m);
+
+        /**
+           \brief Add the lemma \c lemma of level \c lvl of predicate \c pred, found by
+           context \c owner which uses the manager \c src.
+        */
+        void publish(unsigned owner, ast_manager& src, func_decl* pred, expr* lemma, unsigned lvl);
+
+        /**
+           \brief Retrieve, translated to \c dst, the lemmas from position \c head on that
+           were not published by \c owner. Return the position following the last lemma.
+        */
+        unsigned fetch(unsigned owner, unsigned head, ast_manager& dst, func_decl_ref_vector& preds, 
+                       expr_ref_vector& lemmas, unsigned_vector& levels);
+    };
+
     class context {
 
         struct stats {
             unsigned m_num_nodes;
             unsigned m_max_depth;
+            unsigned m_num_imported;
+            unsigned m_num_exported;
             stats() { reset(); }
             void reset() { memset(this, 0, sizeof(*this)); }
         };
@@ -338,6 +399,10 @@ namespace pdr {
         stats                m_stats;
         model_converter_ref  m_mc;
         proof_converter_ref  m_pc;
+        lemma_exchange*      m_exchange;
+        unsigned             m_worker_id;
+        unsigned             m_exchange_head;
+        bool                 m_importing;
         
         // Functions used by search.
         void solve_impl();
@@ -364,6 +429,8 @@ namespace pdr {
 
         void checkpoint();
 
+        void import_lemmas();
+
         void init_rules(datalog::rule_set& rules, decl2rel& transformers);
 
         void simplify_formulas();
@@ -439,6 +506,14 @@ namespace pdr {
 
         model_node& get_root() const { return m_search.get_root(); }
 
+        /**
+           \brief Share the lemmas of this context through \c e, as the context \c worker_id
+           of a parallel run. Pass 0 to stop sharing.
+        */
+        void set_lemma_exchange(lemma_exchange* e, unsigned worker_id);
+
+        void export_lemma(func_decl* pred, expr* lemma, unsigned lvl);
+
     };
 
 };
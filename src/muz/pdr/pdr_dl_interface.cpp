@@ -34,6 +34,8 @@ Revision History:
 #include "dl_transforms.h"
 #include "scoped_proof.h"
 #include "model_smt2_pp.h"
+#include "ast_translation.h"
+#include "z3_omp.h"
 
 using namespace pdr;
 
@@ -165,11 +167,155 @@ lbool dl_interface::query(expr * query) {
         IF_VERBOSE(1, model_smt2_pp(verbose_stream(), m, *m_context->get_model(),0););
         return l_false;
     }
+
+    unsigned num_threads = m_ctx.get_params().pdr_threads();
+    if (num_threads > 1) {
+        return solve_parallel(num_threads, query_pred, bg_assertion);
+    }
         
     return m_context->solve();
 
 }
 
+namespace pdr {
+
+    class null_register_engine : public datalog::register_engine_base {
+    public:
+        virtual datalog::engine_base* mk_engine(datalog::DL_ENGINE engine_type) { return 0; }
+        virtual void set_context(datalog::context* ctx) {}
+    };
+
+    /**
+       \brief Context of a helper thread of a parallel PDR run, with its own copy of 
+       the manager, the parameters and the rules.
+    */
+    struct pdr_worker {
+        ast_manager          m;
+        smt_params           m_fparams;
+        params_ref           m_params;
+        null_register_engine m_register_engine;
+        datalog::context     m_ctx;
+        datalog::rule_set    m_rules;
+        pdr::context         m_context;
+        pdr_worker(ast_manager& m0, smt_params const& fparams, params_ref const& p):
+            m(m0, true),
+            m_fparams(fparams),
+            m_params(p),
+            m_ctx(m, m_register_engine, m_fparams, m_params),
+            m_rules(m_ctx),
+            m_context(m_fparams, m_ctx.get_params(), m) {}
+    };
+};
+
+//
+// Run the main context together with num_threads-1 helper contexts that
+// search in a different order (model search strategy and random seed).
+// The contexts share their lemmas, and the result is the one of the main
+// context, so models, proofs and covers are available as usual.
+// 
+lbool dl_interface::solve_parallel(unsigned num_threads, func_decl* query_pred, expr* bg_assertion) {
+#ifdef _NO_OMP_
+    return m_context->solve();
+#else
+    if (omp_in_parallel()) {
+        return m_context->solve();
+    }
+    ast_manager& m = m_ctx.get_manager();
+    lemma_exchange exchange(m);
+    scoped_ptr_vector<pdr_worker> workers;
+    for (unsigned i = 1; i < num_threads; ++i) {
+        params_ref p(m_ctx.get_params_ref());
+        if (i % 2 == 1) {
+            p.set_bool("pdr.bfs_model_search", !m_ctx.get_params().pdr_bfs_model_search());
+        }
+        smt_params fparams(m_ctx.get_fparams());
+        fparams.m_random_seed += i;
+        pdr_worker* w = alloc(pdr_worker, m, fparams, p);
+        workers.push_back(w);
+        ast_translation tr(m, w->m);
+        datalog::rule_manager& rm = w->m_ctx.get_rule_manager();
+        datalog::rule_set::iterator it = m_pdr_rules.begin(), end = m_pdr_rules.end();
+        for (; it != end; ++it) {
+            datalog::rule& r = **it;
+            app_ref_vector tail(w->m);
+            svector<bool> is_neg;
+            for (unsigned j = 0; j < r.get_tail_size(); ++j) {
+                tail.push_back(tr(r.get_tail(j)));
+                is_neg.push_back(r.is_neg_tail(j));
+            }
+            app_ref head(tr(r.get_head()), w->m);
+            w->m_rules.add_rule(rm.mk(head, tail.size(), tail.c_ptr(), is_neg.c_ptr(), r.name(), false));
+        }
+        w->m_rules.close();
+        w->m_context.set_query(tr(query_pred));
+        w->m_context.set_axioms(tr(bg_assertion));
+        w->m_context.update_rules(w->m_rules);
+        w->m_context.set_lemma_exchange(&exchange, i);
+        m.limit().push_child(&w->m.limit());
+    }
+    m_context->set_lemma_exchange(&exchange, 0);
+
+    lbool result = l_undef;
+    bool has_error = false;
+    unsigned error_code = 0;
+    std::string ex_msg;
+
+    #pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < static_cast<int>(num_threads); ++i) {
+        if (i == 0) {
+            try {
+                result = m_context->solve();
+            }
+            catch (z3_error & err) {
+                has_error = true;
+                error_code = err.error_code();
+            }
+            catch (z3_exception & ex) {
+                ex_msg = ex.msg();
+            }
+            // the helpers are only useful to the main context.
+            for (unsigned j = 0; j < workers.size(); ++j) {
+                workers[j]->m.limit().cancel();
+            }
+        }
+        else {
+            try {
+                workers[i-1]->m_context.solve();
+            }
+            catch (z3_exception &) {
+                // canceled, or failed on its own: the main context does not depend on it.
+            }
+        }
+    }
+
+    m_context->set_lemma_exchange(0, 0);
+    m_worker_stats.reset();
+    for (unsigned i = 0; i < workers.size(); ++i) {
+        m.limit().pop_child();
+        statistics st;
+        workers[i]->m_context.collect_statistics(st);
+        for (unsigned j = 0; j < st.size(); ++j) {
+            std::ostringstream strm;
+            strm << "PDR worker " << (i + 1) << " " << st.get_key(j);
+            char const* key = symbol(strm.str().c_str()).bare_str();
+            if (st.is_uint(j)) {
+                m_worker_stats.update(key, st.get_uint_value(j));
+            }
+            else {
+                m_worker_stats.update(key, st.get_double_value(j));
+            }
+        }
+    }
+    if (has_error) {
+        throw z3_error(error_code);
+    }
+    if (!ex_msg.empty()) {
+        throw default_exception(ex_msg.c_str());
+    }
+    return result;
+#endif
+}
+
 expr_ref dl_interface::get_cover_delta(int level, func_decl* pred_orig) {
     func_decl* pred = pred_orig;
     m_pred2slice.find(pred_orig, pred);
@@ -192,10 +338,12 @@ unsigned dl_interface::get_num_levels(func_decl* pred) {
 
 void dl_interface::collect_statistics(statistics& st) const {
     m_context->collect_statistics(st);
+    st.copy(m_worker_stats);
 }
 
 void dl_interface::reset_statistics() {
     m_context->reset_statistics();
+    m_worker_stats.reset();
 }
 
 void dl_interface::display_certificate(std::ostream& out) const {
@@ -42,9 +42,12 @@ namespace pdr {
         context*          m_context;
         obj_map<func_decl, func_decl*> m_pred2slice;
         ast_ref_vector    m_refs;
+        statistics        m_worker_stats;
 
         void check_reset();
 
+        lbool solve_parallel(unsigned num_threads, func_decl* query_pred, expr* bg_assertion);
+
     public:
         dl_interface(datalog::context& ctx); 
         ~dl_interface();
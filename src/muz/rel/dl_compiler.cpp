@@ -1094,7 +1094,7 @@ namespace datalog {
 
     void compiler::compile_loop(const func_decl_vector & head_preds, const func_decl_set & widened_preds,
             const pred2idx & global_head_deltas, const pred2idx & global_tail_deltas, 
-            const pred2idx & local_deltas, instruction_block & acc) {
+            const pred2idx & local_deltas, instruction_block & acc, const pred2idx * accumulators) {
         instruction_block * loop_body = alloc(instruction_block);
         loop_body->set_observer(&m_instruction_observer);
 
@@ -1110,6 +1110,14 @@ namespace datalog {
 
         svector<reg_idx> loop_control_regs; //loop is controlled by global src regs
         collect_map_range(loop_control_regs, global_tail_deltas);
+        if (accumulators) {
+            //keep the new tuples of this iteration
+            pred2idx::iterator it = global_head_deltas.begin(), end = global_head_deltas.end();
+            for (; it != end; ++it) {
+                make_union(it->m_value, accumulators->find(it->m_key), execution_context::void_register, 
+                    false, *loop_body);
+            }
+        }
         //move target deltas into source deltas at the end of the loop
         //and clear local deltas
         make_inloop_delta_transition(global_head_deltas, global_tail_deltas, local_deltas, *loop_body);
@@ -1249,6 +1257,98 @@ namespace datalog {
         return true;
     }
 
+    compiler::reg_idx compiler::get_change_register(func_decl * pred) {
+        reg_idx reg;
+        if (!m_change_regs.find(pred, reg)) {
+            relation_signature sig;
+            m_context.get_rel_context()->get_rmanager().from_predicate(pred, sig);
+            reg = get_fresh_register(sig);
+            m_change_regs.insert(pred, reg);
+        }
+        return reg;
+    }
+
+    bool compiler::is_incremental_stratum(const func_decl_set & preds) const {
+        if (!all_saturated(preds)) {
+            return false;
+        }
+        func_decl_set::iterator it = preds.begin(), end = preds.end();
+        for (; it != end; ++it) {
+            const rule_vector & rules = m_rule_set.get_predicate_rules(*it);
+            for (unsigned i = 0; i < rules.size(); ++i) {
+                rule * r = rules[i];
+                unsigned psz = r->get_positive_tail_size();
+                unsigned tsz = r->get_uninterpreted_tail_size();
+                for (unsigned j = 0; j < tsz; ++j) {
+                    func_decl * tail_pred = r->get_decl(j);
+                    if (m_recomputed.contains(tail_pred)) {
+                        return false;
+                    }
+                    //new tuples in a negated relation can invalidate tuples of the stratum
+                    if (j >= psz && m_change_regs.contains(tail_pred)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void compiler::compile_incremental_stratum(const func_decl_set & preds, instruction_block & acc) {
+        bool changed = false;
+        func_decl_set::iterator it = preds.begin(), end = preds.end();
+        for (; !changed && it != end; ++it) {
+            changed = m_change_regs.contains(*it);
+            const rule_vector & rules = m_rule_set.get_predicate_rules(*it);
+            for (unsigned i = 0; !changed && i < rules.size(); ++i) {
+                rule * r = rules[i];
+                for (unsigned j = 0; !changed && j < r->get_positive_tail_size(); ++j) {
+                    changed = m_change_regs.contains(r->get_decl(j));
+                }
+            }
+        }
+        if (!changed) {
+            //the stratum is still saturated
+            return;
+        }
+
+        if (is_nonrecursive_stratum(preds)) {
+            func_decl * head_pred = *preds.begin();
+            reg_idx change_reg = get_change_register(head_pred);
+            const rule_vector & rules = m_rule_set.get_predicate_rules(head_pred);
+            for (unsigned i = 0; i < rules.size(); ++i) {
+                compile_rule_evaluation(rules[i], &m_change_regs, change_reg, false, acc);
+            }
+            return;
+        }
+
+        func_decl_vector preds_vector;
+        func_decl_set global_deltas_dummy;
+        detect_chains(preds, preds_vector, global_deltas_dummy);
+
+        pred2idx d_global_src;
+        get_fresh_registers(preds, d_global_src);
+        pred2idx d_global_tgt;
+        get_fresh_registers(preds, d_global_tgt);
+        pred2idx d_local;
+        pred2idx changes;
+        for (it = preds.begin(); it != end; ++it) {
+            changes.insert(*it, get_change_register(*it));
+        }
+
+        //facts added to the predicates of the stratum seed the loop together with the
+        //consequences of the changes in the tails
+        for (it = preds.begin(); it != end; ++it) {
+            make_union(changes.find(*it), d_global_src.find(*it), execution_context::void_register, false, acc);
+        }
+        func_decl_set empty_func_decl_set;
+        compile_preds(preds_vector, empty_func_decl_set, &m_change_regs, d_global_src, acc);
+        for (it = preds.begin(); it != end; ++it) {
+            make_union(d_global_src.find(*it), changes.find(*it), execution_context::void_register, false, acc);
+        }
+        compile_loop(preds_vector, empty_func_decl_set, d_global_tgt, d_global_src, d_local, acc, &changes);
+    }
+
     void compiler::compile_strats(const rule_stratifier & stratifier, 
             const pred2idx * input_deltas, const pred2idx & output_deltas, 
             bool add_saturation_marks, instruction_block & acc) {
@@ -1258,7 +1358,21 @@ namespace datalog {
         for(; sit!=send; ++sit) {
             func_decl_set & strat_preds = **sit;
 
-            if (all_saturated(strat_preds)) {
+            if (m_incremental && is_incremental_stratum(strat_preds)) {
+                compile_incremental_stratum(strat_preds, acc);
+                continue;
+            }
+            if (m_incremental) {
+                //the stratum is rebuilt from scratch, and so are the strata that depend on it
+                func_decl_set::iterator pit = strat_preds.begin(), pend = strat_preds.end();
+                for (; pit != pend; ++pit) {
+                    if (m_context.get_rel_context()->get_rmanager().is_saturated(*pit)) {
+                        acc.push_back(instruction::mk_dealloc(m_pred_regs.find(*pit)));
+                    }
+                    m_recomputed.insert(*pit);
+                }
+            }
+            else if (all_saturated(strat_preds)) {
                 //all predicates in stratum are saturated, so no need to compile rules for them
                 continue;
             }
@@ -120,6 +120,16 @@ namespace datalog {
         instruction_observer              m_instruction_observer;
         expr_free_vars                    m_free_vars;
 
+        /**
+           In incremental compilation, the strata saturated by a previous run are only updated
+           with the tuples that follow from the changes since that run. \c m_change_regs holds 
+           for each predicate the register with the tuples added to it in this run, and
+           \c m_recomputed the predicates whose relations were rebuilt from scratch.
+        */
+        bool                              m_incremental;
+        pred2idx                          m_change_regs;
+        func_decl_set                     m_recomputed;
+
 
         /**
            If true, the union operation on the underlying structure only provides the information
@@ -227,9 +237,14 @@ namespace datalog {
 
         void make_inloop_delta_transition(const pred2idx & global_head_deltas, 
             const pred2idx & global_tail_deltas, const pred2idx & local_deltas, instruction_block & acc);
+        /**
+           \brief Generate the saturation loop of a stratum. If \c accumulators is given, the new
+           tuples of every iteration are also added to the registers it maps the head predicates to.
+        */
         void compile_loop(const func_decl_vector & head_preds, const func_decl_set & widened_preds,
             const pred2idx & global_head_deltas, const pred2idx & global_tail_deltas, 
-            const pred2idx & local_deltas, instruction_block & acc);
+            const pred2idx & local_deltas, instruction_block & acc, 
+            const pred2idx * accumulators = 0);
         void compile_dependent_rules(const func_decl_set & head_preds,
             const pred2idx * input_deltas, const pred2idx & output_deltas, 
             bool add_saturation_marks, instruction_block & acc);
@@ -255,13 +270,28 @@ namespace datalog {
 
         bool all_saturated(const func_decl_set & preds) const;
 
+        reg_idx get_change_register(func_decl * pred);
+
+        /**
+           \brief Return true if the stratum \c preds can be updated incrementally: it was saturated 
+           by a previous run, it has no negated tails, and none of its tails was recomputed.
+        */
+        bool is_incremental_stratum(const func_decl_set & preds) const;
+
+        /**
+           \brief Generate code that propagates the changes of the tail predicates of a stratum 
+           that is incremental into its predicates.
+        */
+        void compile_incremental_stratum(const func_decl_set & preds, instruction_block & acc);
+
         void reset();
 
         explicit compiler(context & ctx, rule_set const & rules, instruction_block & top_level_code) 
             : m_context(ctx), 
             m_rule_set(rules),
             m_top_level_code(top_level_code),
-            m_instruction_observer(*this) {}
+            m_instruction_observer(*this),
+            m_incremental(false) {}
         
         /**
            \brief Compile \c rules in to pseudocode.
@@ -279,6 +309,24 @@ namespace datalog {
                 .do_compilation(execution_code, termination_code);
         }
 
+        /**
+           \brief Compile \c rules so that the strata saturated by a previous run are only updated 
+           with the consequences of the facts added to the predicates in \c changed.
+
+           For each predicate in \c changed, \c new_fact_regs receives the register into which the caller must put the relation of added facts before running the code.
+        */
+        static void compile_incremental(context & ctx, rule_set const & rules, func_decl_set const & changed,
+                obj_map<func_decl, reg_idx> & new_fact_regs, instruction_block & execution_code, 
+                instruction_block & termination_code) {
+            compiler c(ctx, rules, execution_code);
+            c.m_incremental = true;
+            func_decl_set::iterator it = changed.begin(), end = changed.end();
+            for (; it != end; ++it) {
+                new_fact_regs.insert(*it, c.get_change_register(*it));
+            }
+            c.do_compilation(execution_code, termination_code);
+        }
+
     };
 
 
@@ -37,7 +37,9 @@ namespace datalog {
     execution_context::execution_context(context & context) 
         : m_context(context),
         m_stopwatch(0),
-        m_timelimit_ms(0) {}
+        m_timelimit_ms(0),
+        m_iteration_limit(0),
+        m_iterations(0) {}
 
     execution_context::~execution_context() {
         reset();
@@ -56,6 +58,7 @@ namespace datalog {
         m_registers.reset();
         m_reg_annotation.reset();
         reset_timelimit();
+        set_iteration_limit(0);
     }
 
     rel_context& execution_context::get_rel_context() { 
@@ -120,6 +123,7 @@ namespace datalog {
         return 
             m_context.canceled() ||
             memory::above_high_watermark() ||
+            iteration_limit_reached() ||
             (m_stopwatch && 
              m_timelimit_ms != 0 &&
              m_timelimit_ms < static_cast<unsigned>(1000*m_stopwatch->get_current_seconds()));
@@ -337,6 +341,7 @@ namespace datalog {
                     TRACE("dl", tout << "while loop terminated before completion\n";);
                     return false;
                 }
+                ctx.inc_iterations();
             }
             TRACE("dl", tout << "while loop exited\n";);
             return true;
@@ -66,6 +66,8 @@ namespace datalog {
         reg_annotations     m_reg_annotation;
         stopwatch *         m_stopwatch;
         unsigned            m_timelimit_ms; //zero means no limit
+        unsigned            m_iteration_limit; //zero means no limit
+        unsigned            m_iterations;
     public:
         execution_context(context & context);
         ~execution_context();
@@ -77,6 +79,12 @@ namespace datalog {
 
         void set_timelimit(unsigned time_in_ms);
         void reset_timelimit();
+        /**
+           \brief Terminate after \c n iterations of the fixpoint loops. Zero means no limit.
+        */
+        void set_iteration_limit(unsigned n) { m_iteration_limit = n; m_iterations = 0; }
+        void inc_iterations() { ++m_iterations; }
+        bool iteration_limit_reached() const { return m_iteration_limit != 0 && m_iterations >= m_iteration_limit; }
         bool should_terminate();
 
         struct stats {
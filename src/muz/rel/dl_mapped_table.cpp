@@ -0,0 +1,543 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_mapped_table.cpp
+
+Abstract:
+
+    Table that keeps its rows in sorted column-wise runs, which are stored
+    in memory-mapped files once they grow large.
+
+Revision History:
+
+--*/
+
+#include<algorithm>
+#include<cstdio>
+#include<cstring>
+#ifdef _WINDOWS
+#include<windows.h>
+#include<io.h>
+#else
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#endif
+#include"dl_mapped_table.h"
+#include"dl_relation_manager.h"
+#include"dl_context.h"
+
+namespace datalog {
+
+    // -----------------------------------
+    //
+    // mapped_file
+    //
+    // -----------------------------------
+
+    /**
+       \brief Anonymous temporary file mapped into memory for reading and writing.
+    */
+    class mapped_file {
+        char *   m_data;
+        size_t   m_size;
+        FILE *   m_tmp;
+#ifdef _WINDOWS
+        HANDLE   m_mapping;
+#endif
+
+        mapped_file(): m_data(0), m_size(0), m_tmp(0)
+#ifdef _WINDOWS
+            , m_mapping(0)
+#endif
+        {}
+
+    public:
+        ~mapped_file() {
+#ifdef _WINDOWS
+            if (m_data) UnmapViewOfFile(m_data);
+            if (m_mapping) CloseHandle(m_mapping);
+#else
+            if (m_data) munmap(m_data, m_size);
+#endif
+            if (m_tmp) fclose(m_tmp);
+        }
+
+        char * data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+        /**
+           \brief Map a new temporary file of \c size bytes for reading and writing. The file
+           is deleted when it is closed. Return 0 if it cannot be created.
+        */
+        static mapped_file * mk_temp(size_t size) {
+            SASSERT(size > 0);
+            mapped_file * f = alloc(mapped_file);
+            f->m_tmp = tmpfile();
+            if (f->m_tmp) {
+                f->m_size = size;
+#ifdef _WINDOWS
+                HANDLE h = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(f->m_tmp)));
+                uint64 sz = size;
+                f->m_mapping = CreateFileMappingA(h, 0, PAGE_READWRITE, static_cast<DWORD>(sz >> 32),
+                                                  static_cast<DWORD>(sz), 0);
+                if (f->m_mapping) {
+                    f->m_data = static_cast<char *>(MapViewOfFile(f->m_mapping, FILE_MAP_WRITE, 0, 0, size));
+                }
+#else
+                int fd = fileno(f->m_tmp);
+                if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+                    void * p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    if (p != MAP_FAILED) {
+                        f->m_data = static_cast<char *>(p);
+                    }
+                }
+#endif
+            }
+            if (!f->m_data) {
+                dealloc(f);
+                return 0;
+            }
+            return f;
+        }
+    };
+
+    // -----------------------------------
+    //
+    // mapped_table
+    //
+    // -----------------------------------
+
+    static const uint64 MAPPED_TABLE_MAGIC = 0x004c45524c44335aull;
+    static const unsigned MAPPED_TABLE_HEADER_SIZE = 4;
+
+    mapped_table::mapped_table(mapped_table_plugin & plugin, const table_signature & sig)
+        : table_base(plugin, sig),
+          m_num_cols(sig.size()) {
+    }
+
+    mapped_table::~mapped_table() {
+        release(m_run);
+    }
+
+    /**
+       \brief Lexicographic order on the rows of a view.
+    */
+    class mapped_table::rows_view_lt {
+        rows_view const & m_view;
+        unsigned          m_num_cols;
+    public:
+        rows_view_lt(rows_view const & v, unsigned num_cols): m_view(v), m_num_cols(num_cols) {}
+        bool operator()(unsigned r1, unsigned r2) const {
+            for (unsigned i = 0; i < m_num_cols; ++i) {
+                table_element v1 = m_view.get(r1, i);
+                table_element v2 = m_view.get(r2, i);
+                if (v1 != v2) {
+                    return v1 < v2;
+                }
+            }
+            return false;
+        }
+    };
+
+    int mapped_table::compare(unsigned row, rows_view const & v, unsigned vrow) const {
+        for (unsigned i = 0; i < m_num_cols; ++i) {
+            table_element v1 = get(row, i);
+            table_element v2 = v.get(vrow, i);
+            if (v1 != v2) {
+                return v1 < v2 ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    bool mapped_table::find(const table_element * f, unsigned & row) const {
+        rows_view v(f, 0, 1);
+        unsigned lo = 0, hi = num_rows();
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            int c = compare(mid, v, 0);
+            if (c == 0) {
+                row = mid;
+                return true;
+            }
+            if (c < 0) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return false;
+    }
+
+    void mapped_table::alloc_run(unsigned capacity, run & r) const {
+        SASSERT(!r.m_file && r.m_heap.empty());
+        r.m_num_rows = 0;
+        r.m_stride = capacity;
+        size_t num_elems = static_cast<size_t>(capacity) * m_num_cols;
+        if (capacity > 0 && capacity >= get_plugin().spill_rows()) {
+            r.m_file = mapped_file::mk_temp(num_elems * sizeof(table_element));
+            if (r.m_file) {
+                r.m_data = reinterpret_cast<table_element *>(r.m_file->data());
+                return;
+            }
+            IF_VERBOSE(1, verbose_stream() << "(datalog could not create a mapped file, keeping "
+                       << capacity << " rows in memory)\n";);
+        }
+        r.m_heap.resize(static_cast<unsigned>(num_elems));
+        r.m_data = r.m_heap.c_ptr();
+    }
+
+    void mapped_table::release(run & r) {
+        if (r.m_file) {
+            dealloc(r.m_file);
+            r.m_file = 0;
+        }
+        r.m_heap.finalize();
+        r.m_data = 0;
+        r.m_num_rows = 0;
+        r.m_stride = 0;
+    }
+
+    void mapped_table::set_run(run & r) const {
+        release(m_run);
+        m_run.m_file = r.m_file;
+        m_run.m_heap.swap(r.m_heap);
+        m_run.m_data = r.m_data;
+        m_run.m_num_rows = r.m_num_rows;
+        m_run.m_stride = r.m_stride;
+        r.m_file = 0;
+        release(r);
+    }
+
+    void mapped_table::merge(rows_view const & v, unsigned n, const unsigned * order, table_base * delta) const {
+        if (n == 0) {
+            return;
+        }
+        unsigned n1 = num_rows();
+        run res;
+        alloc_run(n1 + n, res);
+        table_element * data = res.m_data;
+        unsigned stride = res.m_stride;
+        unsigned out = 0;
+        unsigned i = 0;
+        rows_view_lt lt(v, m_num_cols);
+        table_fact row;
+        for (unsigned k = 0; k < n; ++k) {
+            if (k > 0 && !lt(order[k-1], order[k])) {
+                continue; // duplicate row
+            }
+            unsigned r = order[k];
+            int c = -1;
+            for (; i < n1 && (c = compare(i, v, r)) < 0; ++i, ++out) {
+                for (unsigned j = 0; j < m_num_cols; ++j) {
+                    data[j * stride + out] = get(i, j);
+                }
+            }
+            if (i < n1 && c == 0) {
+                continue; // already in the table
+            }
+            if (delta) {
+                row.reset();
+            }
+            for (unsigned j = 0; j < m_num_cols; ++j) {
+                table_element e = v.get(r, j);
+                data[j * stride + out] = e;
+                if (delta) {
+                    row.push_back(e);
+                }
+            }
+            ++out;
+            if (delta) {
+                delta->add_fact(row);
+            }
+        }
+        for (; i < n1; ++i, ++out) {
+            for (unsigned j = 0; j < m_num_cols; ++j) {
+                data[j * stride + out] = get(i, j);
+            }
+        }
+        res.m_num_rows = out;
+        set_run(res);
+    }
+
+    void mapped_table::normalize() const {
+        if (m_pending.empty()) {
+            return;
+        }
+        unsigned num_pending = m_pending.size() / m_num_cols;
+        unsigned_vector order;
+        for (unsigned i = 0; i < num_pending; ++i) {
+            order.push_back(i);
+        }
+        rows_view v(m_pending.c_ptr(), m_num_cols, 1);
+        std::sort(order.begin(), order.end(), rows_view_lt(v, m_num_cols));
+        merge(v, num_pending, order.c_ptr(), 0);
+        m_pending.finalize();
+    }
+
+    void mapped_table::load(char const * file_name) {
+        // The rows are copied into a run owned by the table: a mapping of the file itself
+        // would change with the file, and fault if the file is truncated.
+        FILE * in = fopen(file_name, "rb");
+        if (!in) {
+            throw default_exception(default_exception::fmt(), "could not read the table file %s", file_name);
+        }
+        uint64 header[MAPPED_TABLE_HEADER_SIZE];
+        bool ok = fread(header, sizeof(uint64), MAPPED_TABLE_HEADER_SIZE, in) == MAPPED_TABLE_HEADER_SIZE &&
+            header[0] == MAPPED_TABLE_MAGIC && header[1] == m_num_cols && header[2] <= header[3] &&
+            header[3] <= UINT_MAX;
+        run r;
+        if (ok) {
+            alloc_run(static_cast<unsigned>(header[3]), r);
+            size_t num_elems = static_cast<size_t>(header[3]) * m_num_cols;
+            ok = fread(r.m_data, sizeof(table_element), num_elems, in) == num_elems;
+        }
+        fclose(in);
+        if (!ok) {
+            release(r);
+            throw default_exception(default_exception::fmt(),
+                                    "the table file %s does not have the layout of a table with %d columns",
+                                    file_name, m_num_cols);
+        }
+        unsigned n = static_cast<unsigned>(header[2]);
+        rows_view v(r.m_data, 1, r.m_stride);
+        const table_signature & sig = get_signature();
+        for (unsigned j = 0; j < m_num_cols; ++j) {
+            for (unsigned i = 0; i < n; ++i) {
+                if (v.get(i, j) >= sig[j]) {
+                    release(r);
+                    throw default_exception(default_exception::fmt(),
+                                            "value out of the domain of column %d in the table file %s",
+                                            j, file_name);
+                }
+            }
+        }
+        rows_view_lt lt(v, m_num_cols);
+        bool sorted = true;
+        for (unsigned i = 1; sorted && i < n; ++i) {
+            sorted = lt(i - 1, i);
+        }
+        if (sorted && empty()) {
+            // the copy is already a valid run
+            r.m_num_rows = n;
+            set_run(r);
+            return;
+        }
+        normalize();
+        unsigned_vector order;
+        for (unsigned i = 0; i < n; ++i) {
+            order.push_back(i);
+        }
+        if (!sorted) {
+            std::sort(order.begin(), order.end(), lt);
+        }
+        merge(v, n, order.c_ptr(), 0);
+        release(r);
+    }
+
+    void mapped_table::add_fact(const table_fact & f) {
+        SASSERT(f.size() == m_num_cols);
+        m_pending.append(m_num_cols, f.c_ptr());
+        if (m_pending.size() / m_num_cols >= get_plugin().spill_rows()) {
+            normalize();
+        }
+    }
+
+    void mapped_table::remove_fact(const table_element* fact) {
+        remove_facts(1, fact);
+    }
+
+    void mapped_table::remove_facts(unsigned fact_cnt, const table_fact * facts) {
+        svector<table_element> rows;
+        for (unsigned i = 0; i < fact_cnt; ++i) {
+            SASSERT(facts[i].size() == m_num_cols);
+            rows.append(m_num_cols, facts[i].c_ptr());
+        }
+        remove_facts(fact_cnt, rows.c_ptr());
+    }
+
+    void mapped_table::remove_facts(unsigned fact_cnt, const table_element * facts) {
+        normalize();
+        unsigned n1 = num_rows();
+        if (fact_cnt == 0 || n1 == 0) {
+            return;
+        }
+        unsigned_vector order;
+        for (unsigned i = 0; i < fact_cnt; ++i) {
+            order.push_back(i);
+        }
+        rows_view v(facts, m_num_cols, 1);
+        std::sort(order.begin(), order.end(), rows_view_lt(v, m_num_cols));
+
+        run res;
+        alloc_run(n1, res);
+        unsigned out = 0;
+        unsigned k = 0;
+        for (unsigned i = 0; i < n1; ++i) {
+            int c = 1;
+            while (k < fact_cnt && (c = compare(i, v, order[k])) > 0) {
+                ++k;
+            }
+            if (k < fact_cnt && c == 0) {
+                continue; // removed
+            }
+            for (unsigned j = 0; j < m_num_cols; ++j) {
+                res.m_data[j * res.m_stride + out] = get(i, j);
+            }
+            ++out;
+        }
+        if (out == n1) {
+            release(res);
+            return;
+        }
+        res.m_num_rows = out;
+        set_run(res);
+    }
+
+    bool mapped_table::contains_fact(const table_fact & f) const {
+        normalize();
+        unsigned row;
+        return find(f.c_ptr(), row);
+    }
+
+    void mapped_table::reset() {
+        release(m_run);
+        m_pending.reset();
+    }
+
+    bool mapped_table::empty() const {
+        return m_pending.empty() && num_rows() == 0;
+    }
+
+    table_base * mapped_table::clone() const {
+        normalize();
+        mapped_table * res = static_cast<mapped_table *>(get_plugin().mk_empty(get_signature()));
+        unsigned n = num_rows();
+        if (n > 0) {
+            run r;
+            res->alloc_run(n, r);
+            for (unsigned j = 0; j < m_num_cols; ++j) {
+                memcpy(r.m_data + j * r.m_stride, m_run.m_data + j * m_run.m_stride, n * sizeof(table_element));
+            }
+            r.m_num_rows = n;
+            res->set_run(r);
+        }
+        return res;
+    }
+
+    class mapped_table::our_iterator_core : public iterator_core {
+        const mapped_table & m_parent;
+        unsigned             m_row;
+
+        class our_row : public row_interface {
+            const our_iterator_core & m_parent;
+        public:
+            our_row(const our_iterator_core & parent) : row_interface(parent.m_parent), m_parent(parent) {}
+
+            virtual void get_fact(table_fact & result) const {
+                result.reset();
+                for (unsigned j = 0; j < m_parent.m_parent.m_num_cols; ++j) {
+                    result.push_back(m_parent.m_parent.get(m_parent.m_row, j));
+                }
+            }
+            virtual table_element operator[](unsigned col) const {
+                return m_parent.m_parent.get(m_parent.m_row, col);
+            }
+        };
+
+        our_row m_row_obj;
+
+    public:
+        our_iterator_core(const mapped_table & t, bool finished) :
+            m_parent(t), m_row(finished ? t.num_rows() : 0), m_row_obj(*this) {}
+
+        virtual bool is_finished() const {
+            return m_row == m_parent.num_rows();
+        }
+
+        virtual row_interface & operator*() {
+            SASSERT(!is_finished());
+            return m_row_obj;
+        }
+        virtual void operator++() {
+            SASSERT(!is_finished());
+            ++m_row;
+        }
+    };
+
+    table_base::iterator mapped_table::begin() const {
+        normalize();
+        return mk_iterator(alloc(our_iterator_core, *this, false));
+    }
+
+    table_base::iterator mapped_table::end() const {
+        normalize();
+        return mk_iterator(alloc(our_iterator_core, *this, true));
+    }
+
+    // -----------------------------------
+    //
+    // mapped_table_plugin
+    //
+    // -----------------------------------
+
+    table_base * mapped_table_plugin::mk_empty(const table_signature & s) {
+        SASSERT(can_handle_signature(s));
+        return alloc(mapped_table, *this, s);
+    }
+
+    mapped_table const& mapped_table_plugin::get(table_base const& t) { return dynamic_cast<mapped_table const&>(t); }
+    mapped_table& mapped_table_plugin::get(table_base& t) { return dynamic_cast<mapped_table&>(t); }
+
+    unsigned mapped_table_plugin::spill_rows() const {
+        return std::max(1u, get_manager().get_context().mapped_table_spill_rows());
+    }
+
+    /**
+       \brief Merge of the rows of the source into the run of the target. The source can
+       be a table of any kind; unless it is a mapped_table, its rows are sorted first.
+    */
+    class mapped_table_plugin::union_fn : public table_union_fn {
+    public:
+        virtual void operator()(table_base & _tgt, const table_base & src, table_base * delta) {
+            mapped_table & tgt = get(_tgt);
+            tgt.normalize();
+            unsigned_vector order;
+            if (src.get_kind() == tgt.get_kind()) {
+                const mapped_table & t = get(src);
+                t.normalize();
+                for (unsigned i = 0; i < t.num_rows(); ++i) {
+                    order.push_back(i);
+                }
+                mapped_table::rows_view v(t.m_run.m_data, 1, t.m_run.m_stride);
+                tgt.merge(v, order.size(), order.c_ptr(), delta);
+                return;
+            }
+            svector<table_element> rows;
+            table_fact row;
+            table_base::iterator it = src.begin(), end = src.end();
+            for (unsigned i = 0; it != end; ++it, ++i) {
+                it->get_fact(row);
+                rows.append(row.size(), row.c_ptr());
+                order.push_back(i);
+            }
+            mapped_table::rows_view v(rows.c_ptr(), tgt.m_num_cols, 1);
+            std::sort(order.begin(), order.end(), mapped_table::rows_view_lt(v, tgt.m_num_cols));
+            tgt.merge(v, order.size(), order.c_ptr(), delta);
+        }
+    };
+
+    table_union_fn * mapped_table_plugin::mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta) {
+        if (tgt.get_kind() != get_kind() || tgt.get_signature() != src.get_signature()) {
+            return 0;
+        }
+        return alloc(union_fn);
+    }
+
+};
@@ -0,0 +1,176 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_mapped_table.h
+
+Abstract:
+
+    Table that keeps its rows in sorted column-wise runs, which are stored
+    in memory-mapped files once they grow large.
+
+    The rows of a table form a single run that is sorted lexicographically
+    and has no duplicates. Added rows are buffered in memory and merged into
+    a new run the next time the table is read, or as soon as the buffer
+    reaches the spill threshold (datalog.mapped_table_spill_rows). Runs of at
+    least that many rows are written to anonymous temporary files and mapped
+    into memory, so the operating system can page them out when memory is
+    tight.
+
+    Input facts can be loaded from binary files with the same layout as the
+    runs (see mapped_table::load). The columns of such a file are read into a
+    new run without parsing; a file whose rows are already sorted becomes the
+    run of an empty table without being merged.
+
+Revision History:
+
+--*/
+#ifndef DL_MAPPED_TABLE_H_
+#define DL_MAPPED_TABLE_H_
+
+#include "dl_base.h"
+#include "dl_util.h"
+
+namespace datalog {
+
+    class mapped_table;
+    class mapped_file;
+
+    class mapped_table_plugin : public table_plugin {
+        friend class mapped_table;
+    protected:
+        class union_fn;
+    public:
+        typedef mapped_table table;
+
+        mapped_table_plugin(relation_manager & manager)
+            : table_plugin(symbol("mapped"), manager) {}
+
+        virtual bool can_handle_signature(const table_signature & s)
+        { return s.size() > 0 && s.functional_columns() == 0; }
+
+        virtual table_base * mk_empty(const table_signature & s);
+
+        static mapped_table const& get(table_base const&);
+        static mapped_table& get(table_base&);
+
+        /**
+           \brief Minimal number of rows of a run that is stored in a memory-mapped file.
+        */
+        unsigned spill_rows() const;
+
+    protected:
+        virtual table_union_fn * mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta);
+    };
+
+    class mapped_table : public table_base {
+        friend class mapped_table_plugin;
+        friend class mapped_table_plugin::union_fn;
+
+        class our_iterator_core;
+
+        /**
+           \brief Rows stored column after column: the element of row \c r in column \c c
+           is at <tt>m_data[c * m_stride + r]</tt>.
+        */
+        struct run {
+            mapped_file *          m_file;
+            svector<table_element> m_heap;
+            table_element *        m_data;
+            unsigned               m_num_rows;
+            unsigned               m_stride;
+            run(): m_file(0), m_data(0), m_num_rows(0), m_stride(0) {}
+        };
+
+        /**
+           \brief Read-only view of rows that are not necessarily in a run: the element of
+           row \c r in column \c c is at <tt>m_data[r * m_row_step + c * m_col_step]</tt>.
+        */
+        struct rows_view {
+            const table_element * m_data;
+            unsigned              m_row_step;
+            unsigned              m_col_step;
+            rows_view(const table_element * data, unsigned row_step, unsigned col_step):
+                m_data(data), m_row_step(row_step), m_col_step(col_step) {}
+            table_element get(unsigned row, unsigned col) const
+            { return m_data[row * m_row_step + col * m_col_step]; }
+        };
+        class rows_view_lt;
+
+        unsigned                       m_num_cols;
+        /**
+           Invariant: the rows of the run are sorted lexicographically and contain no duplicates.
+        */
+        mutable run                    m_run;
+        /**
+           Rows added since the last call to \c normalize, stored row after row.
+        */
+        mutable svector<table_element> m_pending;
+
+        mapped_table(mapped_table_plugin & plugin, const table_signature & sig);
+
+        unsigned num_rows() const { return m_run.m_num_rows; }
+        table_element get(unsigned row, unsigned col) const { return m_run.m_data[col * m_run.m_stride + row]; }
+
+        int compare(unsigned row, rows_view const & v, unsigned vrow) const;
+        bool find(const table_element * f, unsigned & row) const;
+
+        void alloc_run(unsigned capacity, run & r) const;
+        static void release(run & r);
+        void set_run(run & r) const;
+
+        /**
+           \brief Replace the run by its union with the rows <tt>order[0], ..., order[n-1]</tt>
+           of \c v, which must be sorted. The rows that are new to the table are added to
+           \c delta if it is given.
+        */
+        void merge(rows_view const & v, unsigned n, const unsigned * order, table_base * delta) const;
+
+        /**
+           \brief Sort the pending rows and merge them into the run.
+        */
+        void normalize() const;
+
+    public:
+        virtual ~mapped_table();
+
+        mapped_table_plugin & get_plugin() const
+        { return static_cast<mapped_table_plugin &>(table_base::get_plugin()); }
+
+        /**
+           \brief Add the rows stored in the binary file \c file_name.
+
+           The file starts with four 64-bit words: the magic number 0x004c45524c44335a
+           ("Z3DLREL"), the number of columns, the number of rows n, and the stride s >= n.
+           Then come the columns, each of s 64-bit words of which the first n hold the
+           values of the rows. Words are in the native byte order.
+
+           Throws a default_exception if the file cannot be read, does not match the
+           signature, or holds a value outside the domain of its column.
+        */
+        void load(char const * file_name);
+
+        virtual void add_fact(const table_fact & f);
+        virtual void remove_fact(const table_element* fact);
+        virtual void remove_facts(unsigned fact_cnt, const table_fact * facts);
+        virtual void remove_facts(unsigned fact_cnt, const table_element * facts);
+        virtual bool contains_fact(const table_fact & f) const;
+        virtual void reset();
+        virtual bool empty() const;
+        virtual table_base * clone() const;
+
+        virtual iterator begin() const;
+        virtual iterator end() const;
+
+        virtual unsigned get_size_estimate_rows() const { normalize(); return num_rows(); }
+        virtual unsigned get_size_estimate_bytes() const
+        { return (num_rows() * m_num_cols + m_pending.size()) * sizeof(table_element); }
+        virtual bool knows_exact_size() const { return m_pending.empty(); }
+    };
+
+};
+
+#endif /* DL_MAPPED_TABLE_H_ */
+
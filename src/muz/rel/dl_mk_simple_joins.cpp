@@ -567,6 +567,21 @@ namespace datalog {
             //return static_cast<cost>(sz);
         }
 
+        /**
+           \brief Estimated number of distinct values in the column \c arg_index of \c pred.
+           It is the domain size unless the relation manager has recorded cardinalities.
+        */
+        cost get_distinct_values(func_decl * pred, unsigned arg_index) const {
+            rel_context_base* rel = m_context.get_rel_context();
+            if (rel && m_context.profile_joins()) {
+                relation_manager::cardinality const * c = rel->get_rmanager().get_cardinality(pred);
+                if (c && c->m_distinct.size() == pred->get_arity() && c->m_distinct[arg_index] > 0) {
+                    return static_cast<cost>(c->m_distinct[arg_index]);
+                }
+            }
+            return get_domain_size(pred, arg_index);
+        }
+
         unsigned get_stratum(func_decl * pred) const {
             return m_rs_aux_copy.get_predicate_strat(pred);
         }
@@ -588,12 +603,23 @@ namespace datalog {
                     cost curr_size = rel_size;
                     for(unsigned i=0; i<n; i++) {
                         if (!is_var(t->get_arg(i))) {
-                            curr_size /= get_domain_size(pred, i);
+                            curr_size /= get_distinct_values(pred, i);
                         }
                     }
                     return curr_size;
                 }
             }
+            relation_manager::cardinality const * c = m_context.profile_joins() ? rm.get_cardinality(pred) : 0;
+            if (c) {
+                // the relation was observed in an earlier evaluation.
+                cost curr_size = static_cast<cost>(c->m_rows);
+                for(unsigned i=0; i<n; i++) {
+                    if (!is_var(t->get_arg(i))) {
+                        curr_size /= get_distinct_values(pred, i);
+                    }
+                }
+                return curr_size;
+            }
             cost res = 1;
             for(unsigned i=0; i<n; i++) {
                 if (is_var(t->get_arg(i))) {
@@ -616,7 +642,8 @@ namespace datalog {
                 vi.get(i, arg_index1, arg_index2);
                 SASSERT(is_var(t1->get_arg(arg_index1)));
                 if (non_local_vars.contains(to_var(t1->get_arg(arg_index1))->get_idx())) {
-                    inters_size *= get_domain_size(t1_pred, arg_index1);
+                    inters_size *= std::max(get_distinct_values(t1_pred, arg_index1), 
+                                            get_distinct_values(t2_pred, arg_index2));
                 }
                 //joined arguments must have the same domain
                 SASSERT(get_domain_size(t1_pred, arg_index1)==get_domain_size(t2_pred, arg_index2));
@@ -625,13 +652,13 @@ namespace datalog {
             for (unsigned i = 0; i < t1->get_num_args(); ++i) {
                 if (is_var(t1->get_arg(i)) && 
                     !non_local_vars.contains(to_var(t1->get_arg(i))->get_idx())) {
-                    inters_size *= get_domain_size(t1_pred, i);
+                    inters_size *= get_distinct_values(t1_pred, i);
                 }
             }
             for (unsigned i = 0; i < t2->get_num_args(); ++i) {
                 if (is_var(t2->get_arg(i)) && 
                     !non_local_vars.contains(to_var(t2->get_arg(i))->get_idx())) {
-                    inters_size *= get_domain_size(t2_pred, i);
+                    inters_size *= get_distinct_values(t2_pred, i);
                 }
             }
 
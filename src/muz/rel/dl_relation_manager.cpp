@@ -58,6 +58,7 @@ namespace datalog {
         m_relation_plugins.reset();
         m_next_table_fid = 0;
         m_next_relation_fid = 0;
+        m_cardinalities.reset();
     }
 
     dl_decl_util & relation_manager::get_decl_util() const {
@@ -528,6 +529,112 @@ namespace datalog {
         }
     }
 
+    void relation_manager::collect_cardinalities() {
+        typedef hashtable<table_element, table_element_hash, default_eq<table_element> > element_set;
+        // number of rows whose values are counted.
+        const unsigned sample_size = 10000;
+        random_gen rand;
+        relation_map::iterator it=m_relations.begin();
+        relation_map::iterator end=m_relations.end();
+        for(;it!=end;++it) {
+            func_decl * pred = it->m_key;
+            relation_base & r = *it->m_value;
+            cardinality c;
+            c.m_rows = r.get_size_estimate_rows();
+            unsigned n = pred->get_arity();
+            if (r.from_table() && c.m_rows > 0 && n > 0) {
+                const table_base & t = static_cast<table_relation &>(r).get_table();
+                SASSERT(t.get_signature().size() == n);
+                // reservoir sampling: every row ends up in the sample with the same probability.
+                svector<table_element> sample;
+                unsigned seen = 0;
+                table_base::iterator tit = t.begin(), tend = t.end();
+                for (; tit != tend; ++tit, ++seen) {
+                    unsigned slot = seen;
+                    if (seen >= sample_size) {
+                        slot = ((static_cast<unsigned>(rand()) << 15) | static_cast<unsigned>(rand())) % (seen + 1);
+                        if (slot >= sample_size) {
+                            continue;
+                        }
+                    }
+                    for (unsigned i = 0; i < n; ++i) {
+                        if (slot == seen) {
+                            sample.push_back((*tit)[i]);
+                        }
+                        else {
+                            sample[slot * n + i] = (*tit)[i];
+                        }
+                    }
+                }
+                unsigned sampled = sample.size() / n;
+                for (unsigned i = 0; i < n; ++i) {
+                    element_set values;
+                    for (unsigned j = 0; j < sampled; ++j) {
+                        values.insert(sample[j * n + i]);
+                    }
+                    uint64 distinct = values.size();
+                    if (sampled < seen && 2 * distinct > sampled) {
+                        // the values do not repeat much in the sample, assume they keep growing.
+                        distinct = distinct * seen / sampled;
+                    }
+                    distinct = std::min(distinct, static_cast<uint64>(seen));
+                    // the estimate counts the named constants of the sort, which excludes the
+                    // values of table facts.
+                    uint64 sort_size = get_context().get_sort_size_estimate(pred->get_domain(i));
+                    if (sort_size > 0) {
+                        distinct = std::min(distinct, sort_size);
+                    }
+                    c.m_distinct.push_back(static_cast<unsigned>(distinct));
+                }
+            }
+            m_cardinalities.insert(cardinality_key(pred->get_name(), n), c);
+        }
+    }
+
+    const relation_manager::cardinality * relation_manager::get_cardinality(func_decl * pred) const {
+        cardinality_map::entry * e = m_cardinalities.find_core(cardinality_key(pred->get_name(), pred->get_arity()));
+        if (!e) {
+            return 0;
+        }
+        return &e->get_data().m_value;
+    }
+
+    void relation_manager::display_cardinalities(std::ostream & out) const {
+        cardinality_map::iterator it = m_cardinalities.begin(), end = m_cardinalities.end();
+        for (; it != end; ++it) {
+            out << it->m_key.first << " " << it->m_key.second << " " << it->m_value.m_rows;
+            for (unsigned i = 0; i < it->m_value.m_distinct.size(); ++i) {
+                out << " " << it->m_value.m_distinct[i];
+            }
+            out << "\n";
+        }
+    }
+
+    bool relation_manager::read_cardinalities(std::istream & in) {
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream line_in(line);
+            std::string name;
+            if (!(line_in >> name)) {
+                continue;
+            }
+            unsigned arity;
+            cardinality c;
+            if (!(line_in >> arity >> c.m_rows)) {
+                return false;
+            }
+            unsigned d;
+            while (line_in >> d) {
+                c.m_distinct.push_back(d);
+            }
+            if (!line_in.eof() || (!c.m_distinct.empty() && c.m_distinct.size() != arity)) {
+                return false;
+            }
+            m_cardinalities.insert(cardinality_key(symbol(name.c_str()), arity), c);
+        }
+        return true;
+    }
+
     void relation_manager::display_output_tables(rule_set const& rules, std::ostream & out) const {
         const decl_set & output_preds = rules.get_output_predicates();
         decl_set::iterator it=output_preds.begin();
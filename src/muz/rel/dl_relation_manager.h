@@ -77,6 +77,23 @@ namespace datalog {
         typedef ptr_vector<table_plugin> table_plugin_vector;
         typedef ptr_vector<relation_plugin> relation_plugin_vector;
 
+    public:
+        /**
+           \brief Number of rows of a relation and estimated numbers of distinct values in
+           its columns, as observed at the end of an evaluation.
+        */
+        struct cardinality {
+            unsigned        m_rows;
+            unsigned_vector m_distinct;
+            cardinality(): m_rows(0) {}
+        };
+    private:
+        typedef std::pair<symbol, unsigned> cardinality_key;
+        struct cardinality_key_hash {
+            unsigned operator()(cardinality_key const & k) const { return combine_hash(k.first.hash(), k.second); }
+        };
+        typedef map<cardinality_key, cardinality, cardinality_key_hash, default_eq<cardinality_key> > cardinality_map;
+
         context & m_context;
         table_plugin_vector m_table_plugins;
         relation_plugin_vector m_relation_plugins;
@@ -94,6 +111,12 @@ namespace datalog {
 
         decl_set m_saturated_rels;
 
+        /**
+           Cardinalities of the relations, indexed by predicate name and arity so that they 
+           remain valid when the rules are transformed again.
+        */
+        cardinality_map m_cardinalities;
+
         family_id m_next_table_fid;
         family_id m_next_relation_fid;
 
@@ -155,6 +178,27 @@ namespace datalog {
             }
         }
 
+        /**
+           \brief Record the cardinalities of the current relations. The distinct values of a
+           table are counted on a uniform sample of its rows and extrapolated to the whole table.
+        */
+        void collect_cardinalities();
+        /**
+           \brief Return the cardinalities recorded for \c pred, or 0 if there are none.
+        */
+        const cardinality * get_cardinality(func_decl * pred) const;
+        bool has_cardinalities() const { return !m_cardinalities.empty(); }
+        /**
+           \brief Write the recorded cardinalities, one line <tt>name arity rows d_0 ... d_{n-1}</tt>
+           per predicate. The distinct counts are omitted for relations that are not tables.
+        */
+        void display_cardinalities(std::ostream & out) const;
+        /**
+           \brief Add the cardinalities written by \c display_cardinalities. Return false if
+           the input is malformed.
+        */
+        bool read_cardinalities(std::istream & in);
+
         void collect_non_empty_predicates(decl_set & res) const;
         void restrict_predicates(const decl_set & preds);
 
@@ -0,0 +1,533 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_trie_table.cpp
+
+Abstract:
+
+    Table that stores its rows column-wise in lexicographic order.
+
+Revision History:
+
+--*/
+
+#include<algorithm>
+#include"dl_trie_table.h"
+#include"dl_relation_manager.h"
+
+namespace datalog {
+
+    // -----------------------------------
+    //
+    // trie_table
+    //
+    // -----------------------------------
+
+    trie_table::trie_table(trie_table_plugin & plugin, const table_signature & sig)
+        : table_base(plugin, sig),
+          m_num_cols(sig.size()) {
+        m_columns.resize(m_num_cols);
+    }
+
+    int trie_table::compare(unsigned row, const table_element * f) const {
+        for (unsigned i = 0; i < m_num_cols; ++i) {
+            table_element v = get(row, i);
+            if (v != f[i]) {
+                return v < f[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    bool trie_table::find(const table_element * f, unsigned & row) const {
+        unsigned lo = 0, hi = num_rows();
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            int c = compare(mid, f);
+            if (c == 0) {
+                row = mid;
+                return true;
+            }
+            if (c < 0) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return false;
+    }
+
+    /**
+       \brief Lexicographic order on rows stored one after the other.
+    */
+    class pending_row_lt {
+        const table_element * m_rows;
+        unsigned              m_num_cols;
+    public:
+        pending_row_lt(const table_element * rows, unsigned num_cols): m_rows(rows), m_num_cols(num_cols) {}
+        bool operator()(unsigned r1, unsigned r2) const {
+            const table_element * f1 = m_rows + r1 * m_num_cols;
+            const table_element * f2 = m_rows + r2 * m_num_cols;
+            for (unsigned i = 0; i < m_num_cols; ++i) {
+                if (f1[i] != f2[i]) {
+                    return f1[i] < f2[i];
+                }
+            }
+            return false;
+        }
+    };
+
+    void trie_table::normalize() const {
+        if (m_pending.empty()) {
+            return;
+        }
+        unsigned num_pending = m_pending.size() / m_num_cols;
+        unsigned_vector order;
+        for (unsigned i = 0; i < num_pending; ++i) {
+            order.push_back(i);
+        }
+        pending_row_lt lt(m_pending.c_ptr(), m_num_cols);
+        std::sort(order.begin(), order.end(), lt);
+
+        column merged;
+        unsigned n = num_rows();
+        unsigned i = 0;
+        for (unsigned k = 0; k < num_pending; ++k) {
+            if (k > 0 && !lt(order[k-1], order[k])) {
+                continue; // duplicate pending row
+            }
+            const table_element * f = m_pending.c_ptr() + order[k] * m_num_cols;
+            int c = -1;
+            for (; i < n && (c = compare(i, f)) < 0; ++i) {
+                for (unsigned j = 0; j < m_num_cols; ++j) {
+                    merged.push_back(get(i, j));
+                }
+            }
+            if (i < n && c == 0) {
+                continue; // already in the table
+            }
+            merged.append(m_num_cols, f);
+        }
+        for (; i < n; ++i) {
+            for (unsigned j = 0; j < m_num_cols; ++j) {
+                merged.push_back(get(i, j));
+            }
+        }
+        m_pending.reset();
+        set_rows(merged);
+    }
+
+    void trie_table::set_rows(column const & rows) const {
+        unsigned n = rows.size() / m_num_cols;
+        for (unsigned j = 0; j < m_num_cols; ++j) {
+            column & col = m_columns[j];
+            col.reset();
+            col.resize(n);
+            for (unsigned i = 0; i < n; ++i) {
+                col[i] = rows[i * m_num_cols + j];
+            }
+        }
+    }
+
+    /**
+       \brief Lexicographic order on the rows of a trie_table restricted to a list of columns.
+    */
+    class trie_row_lt {
+        vector<svector<table_element> > const & m_columns;
+        unsigned_vector const &                 m_cols;
+    public:
+        trie_row_lt(vector<svector<table_element> > const & columns, unsigned_vector const & cols):
+            m_columns(columns), m_cols(cols) {}
+        bool operator()(unsigned r1, unsigned r2) const {
+            for (unsigned i = 0; i < m_cols.size(); ++i) {
+                svector<table_element> const & col = m_columns[m_cols[i]];
+                if (col[r1] != col[r2]) {
+                    return col[r1] < col[r2];
+                }
+            }
+            return false;
+        }
+    };
+
+    void trie_table::sort_rows(unsigned_vector const & cols, unsigned_vector & order) const {
+        SASSERT(m_pending.empty());
+        unsigned n = num_rows();
+        order.reset();
+        for (unsigned i = 0; i < n; ++i) {
+            order.push_back(i);
+        }
+        bool is_prefix = true;
+        for (unsigned i = 0; is_prefix && i < cols.size(); ++i) {
+            is_prefix = cols[i] == i;
+        }
+        if (!is_prefix) {
+            // the rows are already sorted by any prefix of the columns.
+            std::stable_sort(order.begin(), order.end(), trie_row_lt(m_columns, cols));
+        }
+    }
+
+    unsigned trie_table::seek(unsigned_vector const & order, unsigned col, unsigned lo, unsigned hi,
+                              table_element v, bool past) const {
+        column const & c = m_columns[col];
+#define BEFORE(_i_) (past ? c[order[_i_]] <= v : c[order[_i_]] < v)
+        if (lo >= hi || !BEFORE(lo)) {
+            return lo;
+        }
+        // gallop until the value at lo + step is not before v.
+        unsigned step = 1;
+        while (step < hi - lo && BEFORE(lo + step)) {
+            lo += step;
+            step *= 2;
+        }
+        hi = std::min(hi, lo + step);
+        ++lo;
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            if (BEFORE(mid)) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+#undef BEFORE
+        return lo;
+    }
+
+    void trie_table::add_fact(const table_fact & f) {
+        SASSERT(f.size() == m_num_cols);
+        m_pending.append(m_num_cols, f.c_ptr());
+    }
+
+    void trie_table::remove_fact(const table_element* fact) {
+        normalize();
+        unsigned row;
+        if (!find(fact, row)) {
+            return;
+        }
+        unsigned n = num_rows();
+        for (unsigned j = 0; j < m_num_cols; ++j) {
+            column & col = m_columns[j];
+            for (unsigned i = row + 1; i < n; ++i) {
+                col[i - 1] = col[i];
+            }
+            col.pop_back();
+        }
+    }
+
+    bool trie_table::contains_fact(const table_fact & f) const {
+        normalize();
+        unsigned row;
+        return find(f.c_ptr(), row);
+    }
+
+    void trie_table::reset() {
+        for (unsigned j = 0; j < m_num_cols; ++j) {
+            m_columns[j].reset();
+        }
+        m_pending.reset();
+    }
+
+    bool trie_table::empty() const {
+        return m_pending.empty() && num_rows() == 0;
+    }
+
+    table_base * trie_table::clone() const {
+        normalize();
+        trie_table * res = static_cast<trie_table *>(get_plugin().mk_empty(get_signature()));
+        res->m_columns = m_columns;
+        return res;
+    }
+
+    class trie_table::our_iterator_core : public iterator_core {
+        const trie_table & m_parent;
+        unsigned           m_row;
+
+        class our_row : public row_interface {
+            const our_iterator_core & m_parent;
+        public:
+            our_row(const our_iterator_core & parent) : row_interface(parent.m_parent), m_parent(parent) {}
+
+            virtual void get_fact(table_fact & result) const {
+                result.reset();
+                for (unsigned j = 0; j < m_parent.m_parent.m_num_cols; ++j) {
+                    result.push_back(m_parent.m_parent.get(m_parent.m_row, j));
+                }
+            }
+            virtual table_element operator[](unsigned col) const {
+                return m_parent.m_parent.get(m_parent.m_row, col);
+            }
+        };
+
+        our_row m_row_obj;
+
+    public:
+        our_iterator_core(const trie_table & t, bool finished) :
+            m_parent(t), m_row(finished ? t.num_rows() : 0), m_row_obj(*this) {}
+
+        virtual bool is_finished() const {
+            return m_row == m_parent.num_rows();
+        }
+
+        virtual row_interface & operator*() {
+            SASSERT(!is_finished());
+            return m_row_obj;
+        }
+        virtual void operator++() {
+            SASSERT(!is_finished());
+            ++m_row;
+        }
+    };
+
+    table_base::iterator trie_table::begin() const {
+        normalize();
+        return mk_iterator(alloc(our_iterator_core, *this, false));
+    }
+
+    table_base::iterator trie_table::end() const {
+        normalize();
+        return mk_iterator(alloc(our_iterator_core, *this, true));
+    }
+
+    // -----------------------------------
+    //
+    // trie_table_plugin
+    //
+    // -----------------------------------
+
+    table_base * trie_table_plugin::mk_empty(const table_signature & s) {
+        SASSERT(can_handle_signature(s));
+        return alloc(trie_table, *this, s);
+    }
+
+    trie_table const& trie_table_plugin::get(table_base const& t) { return dynamic_cast<trie_table const&>(t); }
+    trie_table& trie_table_plugin::get(table_base& t) { return dynamic_cast<trie_table&>(t); }
+
+    /**
+       \brief Leapfrog triejoin of two tables on the joined columns.
+
+       Both tables are viewed as tries over their joined columns. At every level the two
+       trie iterators leapfrog over each other with galloping seeks until they agree on a
+       value, and then descend into the sub-tries for that value. Below the last joined
+       column the matching rows are combined.
+    */
+    class trie_table_plugin::join_fn : public convenient_table_join_fn {
+        const trie_table * m_t1;
+        const trie_table * m_t2;
+        unsigned_vector    m_order1;
+        unsigned_vector    m_order2;
+        trie_table::column m_rows;
+
+        void add_product(unsigned lo1, unsigned hi1, unsigned lo2, unsigned hi2) {
+            unsigned n1 = m_t1->m_num_cols;
+            unsigned n2 = m_t2->m_num_cols;
+            for (unsigned i = lo1; i < hi1; ++i) {
+                unsigned r1 = m_order1[i];
+                for (unsigned j = lo2; j < hi2; ++j) {
+                    unsigned r2 = m_order2[j];
+                    for (unsigned k = 0; k < n1; ++k) {
+                        m_rows.push_back(m_t1->get(r1, k));
+                    }
+                    for (unsigned k = 0; k < n2; ++k) {
+                        m_rows.push_back(m_t2->get(r2, k));
+                    }
+                }
+            }
+        }
+
+        void leapfrog(unsigned level, unsigned lo1, unsigned hi1, unsigned lo2, unsigned hi2) {
+            if (level == m_cols1.size()) {
+                add_product(lo1, hi1, lo2, hi2);
+                return;
+            }
+            unsigned c1 = m_cols1[level];
+            unsigned c2 = m_cols2[level];
+            while (lo1 < hi1 && lo2 < hi2) {
+                table_element v1 = m_t1->get(m_order1[lo1], c1);
+                table_element v2 = m_t2->get(m_order2[lo2], c2);
+                if (v1 < v2) {
+                    lo1 = m_t1->seek(m_order1, c1, lo1, hi1, v2, false);
+                }
+                else if (v2 < v1) {
+                    lo2 = m_t2->seek(m_order2, c2, lo2, hi2, v1, false);
+                }
+                else {
+                    unsigned end1 = m_t1->seek(m_order1, c1, lo1, hi1, v1, true);
+                    unsigned end2 = m_t2->seek(m_order2, c2, lo2, hi2, v2, true);
+                    leapfrog(level + 1, lo1, end1, lo2, end2);
+                    lo1 = end1;
+                    lo2 = end2;
+                }
+            }
+        }
+
+    public:
+        join_fn(const table_signature & t1_sig, const table_signature & t2_sig, unsigned col_cnt,
+                const unsigned * cols1, const unsigned * cols2)
+            : convenient_table_join_fn(t1_sig, t2_sig, col_cnt, cols1, cols2),
+              m_t1(0), m_t2(0) {}
+
+        virtual table_base * operator()(const table_base & tb1, const table_base & tb2) {
+            const trie_table & t1 = get(tb1);
+            const trie_table & t2 = get(tb2);
+            t1.normalize();
+            t2.normalize();
+            m_t1 = &t1;
+            m_t2 = &t2;
+            t1.sort_rows(m_cols1, m_order1);
+            t2.sort_rows(m_cols2, m_order2);
+            m_rows.reset();
+            leapfrog(0, 0, t1.num_rows(), 0, t2.num_rows());
+
+            trie_table * res = static_cast<trie_table *>(t1.get_plugin().mk_empty(get_result_signature()));
+            res->m_pending.swap(m_rows);
+            res->normalize();
+            m_order1.reset();
+            m_order2.reset();
+            return res;
+        }
+    };
+
+    table_join_fn * trie_table_plugin::mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2) {
+        if (t1.get_kind() != get_kind() || t2.get_kind() != get_kind()) {
+            return 0;
+        }
+        return alloc(join_fn, t1.get_signature(), t2.get_signature(), col_cnt, cols1, cols2);
+    }
+
+    /**
+       \brief Merge of two sorted tables. The rows of the source that are not in the target
+       are added to the delta.
+    */
+    class trie_table_plugin::union_fn : public table_union_fn {
+        trie_table::column m_rows;
+        table_fact         m_row;
+
+        static int compare(trie_table const & t1, unsigned r1, trie_table const & t2, unsigned r2) {
+            for (unsigned j = 0; j < t1.m_num_cols; ++j) {
+                table_element v1 = t1.get(r1, j);
+                table_element v2 = t2.get(r2, j);
+                if (v1 != v2) {
+                    return v1 < v2 ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        void add_row(trie_table const & t, unsigned r) {
+            for (unsigned j = 0; j < t.m_num_cols; ++j) {
+                m_rows.push_back(t.get(r, j));
+            }
+        }
+
+    public:
+        virtual void operator()(table_base & _tgt, const table_base & _src, table_base * delta) {
+            trie_table & tgt = get(_tgt);
+            const trie_table & src = get(_src);
+            tgt.normalize();
+            src.normalize();
+            unsigned n1 = tgt.num_rows();
+            unsigned n2 = src.num_rows();
+            if (n2 == 0) {
+                return;
+            }
+            unsigned i = 0, j = 0;
+            m_rows.reset();
+            while (i < n1 || j < n2) {
+                int c = i == n1 ? 1 : (j == n2 ? -1 : compare(tgt, i, src, j));
+                if (c < 0) {
+                    add_row(tgt, i++);
+                }
+                else if (c == 0) {
+                    add_row(tgt, i++);
+                    ++j;
+                }
+                else {
+                    if (delta) {
+                        m_row.reset();
+                        for (unsigned k = 0; k < src.m_num_cols; ++k) {
+                            m_row.push_back(src.get(j, k));
+                        }
+                        delta->add_fact(m_row);
+                    }
+                    add_row(src, j++);
+                }
+            }
+            tgt.set_rows(m_rows);
+            m_rows.finalize();
+        }
+    };
+
+    table_union_fn * trie_table_plugin::mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta) {
+        if (tgt.get_kind() != get_kind() || src.get_kind() != get_kind() ||
+            tgt.get_signature() != src.get_signature()) {
+            return 0;
+        }
+        return alloc(union_fn);
+    }
+
+    /**
+       \brief Remove the rows whose joined columns have a match in the negated table.
+
+       The negated table is sorted by its joined columns, and each row is looked up by
+       narrowing the range of candidate rows one column at a time.
+    */
+    class trie_table_plugin::negation_filter_fn : public table_intersection_filter_fn {
+        unsigned_vector    m_cols1;
+        unsigned_vector    m_cols2;
+        unsigned_vector    m_order;
+        trie_table::column m_rows;
+    public:
+        negation_filter_fn(unsigned joined_col_cnt, const unsigned * t_cols, const unsigned * negated_cols)
+            : m_cols1(joined_col_cnt, t_cols),
+              m_cols2(joined_col_cnt, negated_cols) {}
+
+        virtual void operator()(table_base & _t, const table_base & _neg) {
+            trie_table & t = get(_t);
+            const trie_table & neg = get(_neg);
+            t.normalize();
+            neg.normalize();
+            if (neg.num_rows() == 0) {
+                return;
+            }
+            neg.sort_rows(m_cols2, m_order);
+            unsigned n = t.num_rows();
+            m_rows.reset();
+            for (unsigned i = 0; i < n; ++i) {
+                unsigned lo = 0, hi = m_order.size();
+                for (unsigned k = 0; lo < hi && k < m_cols1.size(); ++k) {
+                    table_element v = t.get(i, m_cols1[k]);
+                    lo = neg.seek(m_order, m_cols2[k], lo, hi, v, false);
+                    hi = neg.seek(m_order, m_cols2[k], lo, hi, v, true);
+                }
+                if (lo < hi) {
+                    continue;
+                }
+                for (unsigned j = 0; j < t.m_num_cols; ++j) {
+                    m_rows.push_back(t.get(i, j));
+                }
+            }
+            if (m_rows.size() != n * t.m_num_cols) {
+                t.set_rows(m_rows);
+            }
+            m_rows.finalize();
+            m_order.reset();
+        }
+    };
+
+    table_intersection_filter_fn * trie_table_plugin::mk_filter_by_negation_fn(const table_base & t,
+            const table_base & negated_obj, unsigned joined_col_cnt,
+            const unsigned * t_cols, const unsigned * negated_cols) {
+        if (t.get_kind() != get_kind() || negated_obj.get_kind() != get_kind()) {
+            return 0;
+        }
+        return alloc(negation_filter_fn, joined_col_cnt, t_cols, negated_cols);
+    }
+
+};
+
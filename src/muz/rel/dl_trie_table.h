@@ -0,0 +1,144 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_trie_table.h
+
+Abstract:
+
+    Table that stores its rows column-wise in lexicographic order.
+
+    The sorted columns form an implicit trie: the rows that share a prefix
+    of values in the first k columns are contiguous, so every trie node is
+    a range of row indices. Joins are evaluated with a leapfrog triejoin
+    over the joined columns, and union and negation are merge based.
+
+    Added rows are buffered and merged into the sorted columns the next
+    time the table is read.
+
+Revision History:
+
+--*/
+#ifndef DL_TRIE_TABLE_H_
+#define DL_TRIE_TABLE_H_
+
+#include "dl_base.h"
+#include "dl_util.h"
+
+namespace datalog {
+
+    class trie_table;
+
+    class trie_table_plugin : public table_plugin {
+        friend class trie_table;
+    protected:
+        class join_fn;
+        class union_fn;
+        class negation_filter_fn;
+    public:
+        typedef trie_table table;
+
+        trie_table_plugin(relation_manager & manager)
+            : table_plugin(symbol("trie"), manager) {}
+
+        virtual bool can_handle_signature(const table_signature & s) 
+        { return s.size() > 0 && s.functional_columns() == 0; }
+
+        virtual table_base * mk_empty(const table_signature & s);
+
+        static trie_table const& get(table_base const&);
+        static trie_table& get(table_base&);
+
+    protected:
+        virtual table_join_fn * mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2);
+        virtual table_union_fn * mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta);
+        virtual table_intersection_filter_fn * mk_filter_by_negation_fn(const table_base & t,
+            const table_base & negated_obj, unsigned joined_col_cnt,
+            const unsigned * t_cols, const unsigned * negated_cols);
+    };
+
+    class trie_table : public table_base {
+        friend class trie_table_plugin;
+        friend class trie_table_plugin::join_fn;
+        friend class trie_table_plugin::union_fn;
+        friend class trie_table_plugin::negation_filter_fn;
+
+        class our_iterator_core;
+
+        typedef svector<table_element> column;
+
+        unsigned               m_num_cols;
+        /**
+           Invariant: the rows formed by the columns are sorted lexicographically and
+           contain no duplicates.
+        */
+        mutable vector<column> m_columns;
+        /**
+           Rows added since the last call to \c normalize, stored row after row.
+        */
+        mutable column         m_pending;
+
+        trie_table(trie_table_plugin & plugin, const table_signature & sig);
+
+        unsigned num_rows() const { return m_columns.empty() ? 0 : m_columns[0].size(); }
+        table_element get(unsigned row, unsigned col) const { return m_columns[col][row]; }
+
+        int compare(unsigned row, const table_element * f) const;
+        bool find(const table_element * f, unsigned & row) const;
+
+        /**
+           \brief Sort the pending rows and merge them into the columns.
+        */
+        void normalize() const;
+
+        /**
+           \brief Store in \c order the row indices sorted lexicographically by the
+           columns \c cols. The rows with the same values in \c cols form a contiguous
+           range, which makes \c order a trie over \c cols.
+        */
+        void sort_rows(unsigned_vector const & cols, unsigned_vector & order) const;
+
+        /**
+           \brief Return the first position \c i in <tt>[lo, hi)</tt> such that the value of
+           column \c col in row <tt>order[i]</tt> is at least \c v, or greater than \c v if
+           \c past is set. Returns \c hi if there is no such position.
+
+           The search gallops from \c lo, so advancing a trie iterator by a short
+           distance is cheap.
+        */
+        unsigned seek(unsigned_vector const & order, unsigned col, unsigned lo, unsigned hi,
+                      table_element v, bool past) const;
+
+        /**
+           \brief Replace the content of the columns by the rows in \c rows.
+
+           The rows are stored one after the other and must be sorted and unique.
+        */
+        void set_rows(column const & rows) const;
+    public:
+        trie_table_plugin & get_plugin() const
+        { return static_cast<trie_table_plugin &>(table_base::get_plugin()); }
+
+        virtual void add_fact(const table_fact & f);
+        virtual void remove_fact(const table_element* fact);
+        virtual bool contains_fact(const table_fact & f) const;
+        virtual void reset();
+        virtual bool empty() const;
+        virtual table_base * clone() const;
+
+        virtual iterator begin() const;
+        virtual iterator end() const;
+
+        virtual unsigned get_size_estimate_rows() const { normalize(); return num_rows(); }
+        virtual unsigned get_size_estimate_bytes() const
+        { return (num_rows() * m_num_cols + m_pending.size()) * sizeof(table_element); }
+        virtual bool knows_exact_size() const { return m_pending.empty(); }
+    };
+
+};
+
+#endif /* DL_TRIE_TABLE_H_ */
+
@@ -26,6 +26,7 @@ Revision History:
 #include "tbv.h"
 #include "union_find.h"
 #include "buffer.h"
+#include "map.h"
 
 
 class doc;
@@ -117,8 +118,169 @@ class union_bvec {
         e_fixed
     };
 
+    /**
+       \brief Compute the values of the bits <tt>bits[0], ..., bits[n-1]</tt> of \c t as the
+       bits of \c key, and set in \c mask the bits of the positions that \c t fixes.
+       Return true if \c t fixes all of them.
+    */
+    static bool get_key(T const& t, unsigned const* bits, unsigned n, unsigned& key, unsigned& mask) {
+        SASSERT(n <= 32);
+        key = 0;
+        mask = 0;
+        for (unsigned i = 0; i < n; ++i) {
+            switch (t[bits[i]]) {
+            case BIT_0: mask |= (1u << i); break;
+            case BIT_1: mask |= (1u << i); key |= (1u << i); break;
+            default: break;
+            }
+        }
+        return n == 32 ? mask == UINT_MAX : mask == (1u << n) - 1;
+    }
+
 
 public:
+
+    /**
+       \brief Inserts elements into a union, indexing its elements by the values of a few
+       key bits so that the subsumption checks of \c insert only visit the elements that
+       can contain, or be contained in, the new element.
+
+       An element that fixes all key bits can only contain, or be contained in, elements
+       that agree with it on those bits. Elements with a don't care key bit are kept apart
+       and always checked. The key bits are the bits fixed by most of the elements, and
+       are chosen once the union has \c min_size elements; below that, elements are
+       inserted as by union_bvec::insert. Elements removed because they are subsumed are
+       compacted away when the index is destroyed, so the union must not be accessed
+       otherwise in the meantime.
+    */
+    class index {
+        static const unsigned min_size = 32;
+        static const unsigned max_key_bits = 16;
+        static const unsigned sample_size = 64;
+
+        M&                      m;
+        union_bvec&             m_set;
+        bool                    m_indexed;
+        bool                    m_removed;
+        unsigned_vector         m_key_bits;
+        u_map<unsigned>         m_key2bucket;
+        unsigned_vector         m_bucket_keys;
+        vector<unsigned_vector> m_buckets;   // positions in m_set.m_elems of the elements with the key
+        unsigned_vector         m_wildcards; // positions of the elements with a don't care key bit
+
+        struct more_fixed {
+            unsigned_vector const& m_fixed;
+            more_fixed(unsigned_vector const& fixed): m_fixed(fixed) {}
+            bool operator()(unsigned i, unsigned j) const { return m_fixed[i] > m_fixed[j]; }
+        };
+
+        void add(unsigned pos) {
+            unsigned key, mask;
+            if (!get_key(*m_set.m_elems[pos], m_key_bits.c_ptr(), m_key_bits.size(), key, mask)) {
+                m_wildcards.push_back(pos);
+                return;
+            }
+            unsigned b;
+            if (!m_key2bucket.find(key, b)) {
+                b = m_buckets.size();
+                m_buckets.push_back(unsigned_vector());
+                m_bucket_keys.push_back(key);
+                m_key2bucket.insert(key, b);
+            }
+            m_buckets[b].push_back(pos);
+        }
+
+        void build() {
+            unsigned n = m.num_tbits(), sz = m_set.size();
+            unsigned num_samples = std::min(sz, sample_size);
+            unsigned_vector fixed(n, 0u), key_bits;
+            for (unsigned i = 0; i < num_samples; ++i) {
+                T const& t = *m_set.m_elems[i * sz / num_samples];
+                for (unsigned j = 0; j < n; ++j) {
+                    if (t[j] != BIT_x) ++fixed[j];
+                }
+            }
+            for (unsigned j = 0; j < n; ++j) {
+                if (2 * fixed[j] > num_samples) key_bits.push_back(j);
+            }
+            std::stable_sort(key_bits.begin(), key_bits.end(), more_fixed(fixed));
+            for (unsigned i = 0; i < key_bits.size() && i < max_key_bits; ++i) {
+                m_key_bits.push_back(key_bits[i]);
+            }
+            for (unsigned i = 0; i < sz; ++i) {
+                add(i);
+            }
+            m_indexed = true;
+        }
+
+        bool contains_some(unsigned_vector const& positions, T const& t) const {
+            for (unsigned i = 0; i < positions.size(); ++i) {
+                T* e = m_set.m_elems[positions[i]];
+                if (e && m.contains(*e, t)) return true;
+            }
+            return false;
+        }
+
+        void remove_contained(unsigned_vector& positions, T const& t) {
+            unsigned j = 0;
+            for (unsigned i = 0; i < positions.size(); ++i) {
+                T*& e = m_set.m_elems[positions[i]];
+                if (!e) continue;
+                if (m.contains(t, *e)) {
+                    m.deallocate(e);
+                    e = 0;
+                    m_removed = true;
+                    continue;
+                }
+                positions[j++] = positions[i];
+            }
+            positions.shrink(j);
+        }
+
+    public:
+        index(M& m, union_bvec& s): m(m), m_set(s), m_indexed(false), m_removed(false) {}
+
+        ~index() {
+            if (!m_removed) return;
+            unsigned j = 0;
+            for (unsigned i = 0; i < m_set.m_elems.size(); ++i) {
+                if (m_set.m_elems[i]) m_set.m_elems[j++] = m_set.m_elems[i];
+            }
+            m_set.m_elems.resize(j);
+        }
+
+        /**
+           \brief Same as union_bvec::insert.
+        */
+        bool insert(T* t) {
+            SASSERT(t);
+            if (!m_indexed) {
+                bool r = m_set.insert(m, t);
+                if (m_set.size() >= min_size) build();
+                return r;
+            }
+            unsigned key, mask, b = UINT_MAX;
+            bool all_fixed = get_key(*t, m_key_bits.c_ptr(), m_key_bits.size(), key, mask);
+            if (all_fixed) m_key2bucket.find(key, b);
+            if ((b != UINT_MAX && contains_some(m_buckets[b], *t)) || contains_some(m_wildcards, *t)) {
+                m.deallocate(t);
+                return false;
+            }
+            if (all_fixed) {
+                if (b != UINT_MAX) remove_contained(m_buckets[b], *t);
+            }
+            else {
+                remove_contained(m_wildcards, *t);
+                for (unsigned i = 0; i < m_buckets.size(); ++i) {
+                    if ((m_bucket_keys[i] & mask) == key) remove_contained(m_buckets[i], *t);
+                }
+            }
+            m_set.m_elems.push_back(t);
+            add(m_set.m_elems.size() - 1);
+            return true;
+        }
+    };
+
     unsigned size() const { return m_elems.size(); }
     T& operator[](unsigned idx) const { return *m_elems[idx]; }
     bool is_empty() const { return m_elems.empty(); }
@@ -318,10 +480,53 @@ public:
 
     void join(const union_bvec& d1, const union_bvec& d2, M& dm, M& dm1,
               const unsigned_vector& cols1, const unsigned_vector& cols2) {
+        index idx(dm, *this);
+        if (cols1.empty() || d1.size() * d2.size() < 256) {
+            for (unsigned i = 0; i < d1.size(); ++i) {
+                for (unsigned j = 0; j < d2.size(); ++j) {
+                    if (T *d = dm.join(d1[i], d2[j], dm1, cols1, cols2))
+                        idx.insert(d);
+                }
+            }
+            return;
+        }
+        // group the elements of d2 by the values of their first (up to 32) join bits,
+        // an element of d1 that fixes these bits only joins with the matching group.
+        unsigned num_bits = std::min(cols1.size(), 32u);
+        u_map<unsigned> key2bucket;
+        vector<unsigned_vector> buckets;
+        unsigned_vector wildcards;
+        unsigned key, mask, b;
+        for (unsigned j = 0; j < d2.size(); ++j) {
+            if (!get_key(d2[j], cols2.c_ptr(), num_bits, key, mask)) {
+                wildcards.push_back(j);
+                continue;
+            }
+            if (!key2bucket.find(key, b)) {
+                b = buckets.size();
+                buckets.push_back(unsigned_vector());
+                key2bucket.insert(key, b);
+            }
+            buckets[b].push_back(j);
+        }
         for (unsigned i = 0; i < d1.size(); ++i) {
-            for (unsigned j = 0; j < d2.size(); ++j) {
-                if (T *d = dm.join(d1[i], d2[j], dm1, cols1, cols2))
-                    insert(dm, d);
+            if (!get_key(d1[i], cols1.c_ptr(), num_bits, key, mask)) {
+                for (unsigned j = 0; j < d2.size(); ++j) {
+                    if (T *d = dm.join(d1[i], d2[j], dm1, cols1, cols2))
+                        idx.insert(d);
+                }
+                continue;
+            }
+            if (key2bucket.find(key, b)) {
+                unsigned_vector const& bucket = buckets[b];
+                for (unsigned k = 0; k < bucket.size(); ++k) {
+                    if (T *d = dm.join(d1[i], d2[bucket[k]], dm1, cols1, cols2))
+                        idx.insert(d);
+                }
+            }
+            for (unsigned k = 0; k < wildcards.size(); ++k) {
+                if (T *d = dm.join(d1[i], d2[wildcards[k]], dm1, cols1, cols2))
+                    idx.insert(d);
             }
         }
     }
@@ -37,6 +37,8 @@ Revision History:
 #include"dl_lazy_table.h"
 #include"dl_sparse_table.h"
 #include"dl_table.h"
+#include"dl_trie_table.h"
+#include"dl_mapped_table.h"
 #include"dl_table_relation.h"
 #include"aig_exporter.h"
 #include"dl_mk_simple_joins.h"
@@ -83,12 +85,30 @@ namespace datalog {
             }          
         }
 
-        void reset() {        
+        /**
+           \brief Restart evaluation from the given rules and predicates.
+        */
+        void reset(func_decl_set const& preds, rule_set const& rules) {
             m_ctx.reopen();
-            m_ctx.restrict_predicates(m_preds);
-            m_ctx.replace_rules(m_rules);
+            m_ctx.restrict_predicates(preds);
+            m_ctx.replace_rules(rules);
             m_ctx.close();
         }
+
+        rule_set const& get_rules() const { return m_rules; }
+
+        /**
+           \brief Keep the predicates of \c rules, and with them their relations, after the query.
+        */
+        void keep_predicates(rule_set const& rules) {
+            for (unsigned i = 0; i < rules.get_num_rules(); ++i) {
+                rule * r = rules.get_rule(i);
+                m_preds.insert(r->get_decl());
+                for (unsigned j = 0; j < r->get_uninterpreted_tail_size(); ++j) {
+                    m_preds.insert(r->get_decl(j));
+                }
+            }
+        }
     };
 
     rel_context::rel_context(context& ctx)
@@ -99,7 +119,11 @@ namespace datalog {
           m_answer(m), 
           m_last_result_relation(0),
           m_ectx(ctx),
-          m_sw(0) {
+          m_sw(0),
+          m_incr_source(ctx.get_rule_manager()),
+          m_incr_query(ctx.get_manager()),
+          m_incr_query_pred(ctx.get_manager()),
+          m_incr_reuse(false) {
 
         // register plugins for builtin tables
 
@@ -107,6 +131,8 @@ namespace datalog {
 
         rm.register_plugin(alloc(sparse_table_plugin, rm));
         rm.register_plugin(alloc(hashtable_table_plugin, rm));
+        rm.register_plugin(alloc(trie_table_plugin, rm));
+        rm.register_plugin(alloc(mapped_table_plugin, rm));
         rm.register_plugin(alloc(bitvector_table_plugin, rm));
         rm.register_plugin(alloc(equivalence_table_plugin, rm));
         rm.register_plugin(lazy_table_plugin::mk_sparse(rm));
@@ -125,6 +151,79 @@ namespace datalog {
             m_last_result_relation->deallocate();
             m_last_result_relation = 0;
         }        
+        reset_incremental();
+    }
+
+    bool rel_context::can_reuse_rules(unsigned sz, ast * const * query) const {
+        if (!m_incr_rules) {
+            return false;
+        }
+        rule_set const& rules = m_context.get_rules();
+        if (rules.get_num_rules() != m_incr_source.size() || sz != m_incr_query.size()) {
+            return false;
+        }
+        for (unsigned i = 0; i < m_incr_source.size(); ++i) {
+            if (rules.get_rule(i) != m_incr_source.get(i)) {
+                return false;
+            }
+        }
+        for (unsigned i = 0; i < sz; ++i) {
+            if (query[i] != m_incr_query.get(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void rel_context::save_rules(rule_set const& source, unsigned sz, ast * const * query, func_decl * query_pred) {
+        m_incr_rules = alloc(rule_set, m_context.get_rules());
+        m_incr_source.reset();
+        for (unsigned i = 0; i < source.get_num_rules(); ++i) {
+            m_incr_source.push_back(source.get_rule(i));
+        }
+        m_incr_query.reset();
+        m_incr_query.append(sz, query);
+        m_incr_query_pred = query_pred;
+    }
+
+    void rel_context::reset_incremental() {
+        m_incr_rules = 0;
+        m_incr_source.reset();
+        m_incr_query.reset();
+        m_incr_query_pred = 0;
+        m_incr_reuse = false;
+        obj_map<func_decl, relation_base*>::iterator it = m_new_facts.begin(), end = m_new_facts.end();
+        for (; it != end; ++it) {
+            it->m_value->deallocate();
+        }
+        m_new_facts.reset();
+        m_incr_empty.reset();
+    }
+
+    void rel_context::collect_empty_predicates() {
+        m_incr_empty.reset();
+        rule_set const& rules = m_context.get_rules();
+        rule_set::iterator it = rules.begin(), end = rules.end();
+        for (; it != end; ++it) {
+            rule * r = *it;
+            if (!has_facts(r->get_decl())) {
+                m_incr_empty.insert(r->get_decl());
+            }
+            for (unsigned i = 0; i < r->get_uninterpreted_tail_size(); ++i) {
+                if (!has_facts(r->get_decl(i))) {
+                    m_incr_empty.insert(r->get_decl(i));
+                }
+            }
+        }
+    }
+
+    relation_base & rel_context::get_new_facts(func_decl * pred) {
+        relation_base * r = 0;
+        if (!m_new_facts.find(pred, r)) {
+            r = get_rmanager().mk_empty_relation(get_relation(pred).get_signature(), pred);
+            m_new_facts.insert(pred, r);
+        }
+        return *r;
     }
 
     lbool rel_context::saturate() {
@@ -137,6 +236,15 @@ namespace datalog {
         unsigned remaining_time_limit = m_context.soft_timeout();
         unsigned restart_time = m_context.initial_restart_timeout();
         bool time_limit = remaining_time_limit != 0;
+        // with join profiling, evaluation stops after this many loop iterations to plan the
+        // joins again with the observed sizes. The limit doubles at every re-planning.
+        unsigned replan_iterations = m_context.profile_joins() ? 1 : 0;
+        // a restart evaluates these rules again. Unlike the rules of the scoped query,
+        // they contain the query rule.
+        rule_set restart_rules(m_context.get_rules());
+        func_decl_set restart_preds(m_context.get_predicates());
+        // only the facts added since the last query are propagated, until a restart.
+        bool propagate_new_facts = m_incr_reuse;
                         
         instruction_block termination_code;
 
@@ -144,12 +252,28 @@ namespace datalog {
 
         TRACE("dl", m_context.display(tout););
 
+        symbol profile_file = m_context.cardinality_profile();
+        bool use_profile_file = m_context.profile_joins() && profile_file.size() > 0;
+        if (use_profile_file && !get_rmanager().has_cardinalities()) {
+            std::ifstream in(profile_file.bare_str());
+            if (in && !get_rmanager().read_cardinalities(in)) {
+                warning_msg("could not read the cardinality profile %s", profile_file.bare_str());
+            }
+        }
+
         while (true) {
             m_ectx.reset();
             m_code.reset();
             termination_code.reset();
             m_context.ensure_closed();
-            transform_rules();
+            if (m_incr_reuse) {
+                m_context.reopen();
+                m_context.replace_rules(*m_incr_rules);
+                m_context.close();
+            }
+            else {
+                transform_rules();
+            }
             if (m_context.canceled()) {
                 TRACE("dl", tout << "canceled\n";);
                 result = l_undef;
@@ -169,7 +293,23 @@ namespace datalog {
             ::stopwatch sw;
             sw.start();
 
-            compiler::compile(m_context, m_context.get_rules(), m_code, termination_code);
+            if (propagate_new_facts) {
+                func_decl_set changed;
+                obj_map<func_decl, relation_base*>::iterator it = m_new_facts.begin(), end = m_new_facts.end();
+                for (; it != end; ++it) {
+                    changed.insert(it->m_key);
+                }
+                obj_map<func_decl, unsigned> new_fact_regs;
+                compiler::compile_incremental(m_context, m_context.get_rules(), changed, new_fact_regs, 
+                                              m_code, termination_code);
+                for (it = m_new_facts.begin(); it != end; ++it) {
+                    m_ectx.set_reg(new_fact_regs.find(it->m_key), it->m_value);
+                }
+                m_new_facts.reset();
+            }
+            else {
+                compiler::compile(m_context, m_context.get_rules(), m_code, termination_code);
+            }
 
             bool timeout_after_this_round = time_limit && (restart_time==0 || remaining_time_limit<=restart_time);
 
@@ -179,10 +319,17 @@ namespace datalog {
                     : remaining_time_limit : restart_time;
                 m_ectx.set_timelimit(timeout);
             }
+            m_ectx.set_iteration_limit(replan_iterations);
 
             bool early_termination = !m_code.perform(m_ectx);
+            bool replan = early_termination && m_ectx.iteration_limit_reached();
             m_ectx.reset_timelimit();
+            m_ectx.set_iteration_limit(0);
             VERIFY( termination_code.perform(m_ectx) || m_context.canceled());
+            if (m_context.profile_joins()) {
+                // the next round or query plans its joins with these sizes.
+                get_rmanager().collect_cardinalities();
+            }
 
             m_code.process_all_costs();
             sw.stop();
@@ -206,25 +353,52 @@ namespace datalog {
                 result = l_undef;
                 break;
             }
-            if (timeout_after_this_round) {
-                m_context.set_status(TIMEOUT);
-                TRACE("dl", tout << "timeout\n";);
-                result = l_undef;
-                break;
-            }
-            SASSERT(restart_time != 0);
-            if (time_limit) {
-                SASSERT(remaining_time_limit>restart_time);
-                remaining_time_limit -= restart_time;
-            }
-            uint64 new_restart_time = static_cast<uint64>(restart_time)*m_context.initial_restart_timeout();
-            if (new_restart_time > UINT_MAX) {
-                restart_time = UINT_MAX;
+            if (replan) {
+                unsigned spent = static_cast<unsigned>(1000*sw.get_seconds());
+                if (time_limit && spent >= remaining_time_limit) {
+                    m_context.set_status(TIMEOUT);
+                    TRACE("dl", tout << "timeout\n";);
+                    result = l_undef;
+                    break;
+                }
+                if (time_limit) {
+                    remaining_time_limit -= spent;
+                }
+                TRACE("dl", tout << "re-planning after " << replan_iterations << " iterations\n";);
+                replan_iterations = replan_iterations > UINT_MAX/2 ? UINT_MAX : 2*replan_iterations;
             }
             else {
-                restart_time = static_cast<unsigned>(new_restart_time);
+                if (timeout_after_this_round) {
+                    m_context.set_status(TIMEOUT);
+                    TRACE("dl", tout << "timeout\n";);
+                    result = l_undef;
+                    break;
+                }
+                SASSERT(restart_time != 0);
+                if (time_limit) {
+                    SASSERT(remaining_time_limit>restart_time);
+                    remaining_time_limit -= restart_time;
+                }
+                uint64 new_restart_time = static_cast<uint64>(restart_time)*m_context.initial_restart_timeout();
+                if (new_restart_time > UINT_MAX) {
+                    restart_time = UINT_MAX;
+                }
+                else {
+                    restart_time = static_cast<unsigned>(new_restart_time);
+                }
             }
-            sq.reset();
+            sq.reset(restart_preds, restart_rules);
+            if (propagate_new_facts) {
+                // the interrupted run consumed the new facts, so evaluate the cached rules
+                // from scratch. The rules of the context do not contain the query rule.
+                propagate_new_facts = false;
+                get_rmanager().reset_saturated_marks();
+                reset_negated_tables();
+            }
+        }
+        if (use_profile_file) {
+            std::ofstream out(profile_file.bare_str());
+            get_rmanager().display_cardinalities(out);
         }
         m_context.record_transformed_rules();
         TRACE("dl", display_profile(tout););
@@ -233,14 +407,33 @@ namespace datalog {
  
     lbool rel_context::query(unsigned num_rels, func_decl * const* rels) {
         setup_default_relation();
-        get_rmanager().reset_saturated_marks();
+        ast * const * query = reinterpret_cast<ast * const *>(rels);
+        m_incr_reuse = m_context.incremental() && can_reuse_rules(num_rels, query);
+        if (!m_incr_reuse) {
+            reset_incremental();
+            get_rmanager().reset_saturated_marks();
+            if (m_context.incremental()) {
+                collect_empty_predicates();
+            }
+        }
         scoped_query _scoped_query(m_context);
         for (unsigned i = 0; i < num_rels; ++i) {
             m_context.set_output_predicate(rels[i]);
         }
         m_context.close();
-        reset_negated_tables();
+        if (!m_incr_reuse) {
+            reset_negated_tables();
+        }
         lbool res = saturate(_scoped_query);
+        if (m_context.incremental() && res != l_undef) {
+            if (!m_incr_reuse) {
+                save_rules(_scoped_query.get_rules(), num_rels, query, 0);
+            }
+            _scoped_query.keep_predicates(*m_incr_rules);
+        }
+        else {
+            reset_incremental();
+        }
 
         switch(res) {
         case l_true: {
@@ -332,36 +525,61 @@ namespace datalog {
 
     lbool rel_context::query(expr* query) {
         setup_default_relation();
-        get_rmanager().reset_saturated_marks();
+        ast * query_ast = query;
+        m_incr_reuse = m_context.incremental() && can_reuse_rules(1, &query_ast);
+        if (!m_incr_reuse) {
+            reset_incremental();
+            get_rmanager().reset_saturated_marks();
+            if (m_context.incremental()) {
+                collect_empty_predicates();
+            }
+        }
         scoped_query _scoped_query(m_context);
         rule_manager& rm = m_context.get_rule_manager();
         func_decl_ref query_pred(m);
-        try {
-            query_pred = rm.mk_query(query, m_context.get_rules());
-        }
-        catch (default_exception& exn) {
-            m_context.set_status(INPUT_ERROR);
-            throw exn;
+        if (m_incr_reuse) {
+            // the cached rules already contain the query rule.
+            query_pred = m_incr_query_pred;
+            m_context.close();
         }
+        else {
+            try {
+                query_pred = rm.mk_query(query, m_context.get_rules());
+            }
+            catch (default_exception& exn) {
+                m_context.set_status(INPUT_ERROR);
+                throw exn;
+            }
         
-        m_context.close();
-        reset_negated_tables();
+            m_context.close();
+            reset_negated_tables();
         
-        if (m_context.generate_explanations()) {
-            m_context.transform_rules(alloc(mk_explanations, m_context));
-        }
-
-        query_pred = m_context.get_rules().get_pred(query_pred);
+            if (m_context.generate_explanations()) {
+                m_context.transform_rules(alloc(mk_explanations, m_context));
+            }
 
-        if (m_context.magic_sets_for_queries()) {
-            m_context.transform_rules(alloc(mk_magic_sets, m_context, query_pred));
             query_pred = m_context.get_rules().get_pred(query_pred);
+
+            if (m_context.magic_sets_for_queries()) {
+                m_context.transform_rules(alloc(mk_magic_sets, m_context, query_pred));
+                query_pred = m_context.get_rules().get_pred(query_pred);
+            }
         }
 
         lbool res = saturate(_scoped_query);
         
         query_pred = m_context.get_rules().get_pred(query_pred);
 
+        if (m_context.incremental() && res != l_undef) {
+            if (!m_incr_reuse) {
+                save_rules(_scoped_query.get_rules(), 1, &query_ast, query_pred);
+            }
+            _scoped_query.keep_predicates(*m_incr_rules);
+        }
+        else {
+            reset_incremental();
+        }
+
         if (res != l_undef) {            
             m_last_result_relation = get_relation(query_pred).clone();
             if (m_last_result_relation->empty()) {
@@ -550,7 +768,16 @@ namespace datalog {
     }
  
     void rel_context::add_fact(func_decl* pred, relation_fact const& fact) {
-        get_rmanager().reset_saturated_marks();
+        if (m_incr_rules && m_incr_empty.contains(pred)) {
+            // the cached rules were transformed while pred had no facts.
+            reset_incremental();
+        }
+        if (m_incr_rules) {
+            get_new_facts(pred).add_fact(fact);
+        }
+        else {
+            get_rmanager().reset_saturated_marks();
+        }
         get_relation(pred).add_fact(fact);
         if (m_context.print_aig().size()) {
             m_table_facts.push_back(std::make_pair(pred, fact));
@@ -558,9 +785,19 @@ namespace datalog {
     }
 
     void rel_context::add_fact(func_decl* pred, table_fact const& fact) {
-        get_rmanager().reset_saturated_marks();
+        if (m_incr_rules && m_incr_empty.contains(pred)) {
+            reset_incremental();
+        }
         relation_base & rel0 = get_relation(pred);
         if (rel0.from_table()) {
+            if (m_incr_rules) {
+                relation_base & new_facts = get_new_facts(pred);
+                SASSERT(new_facts.from_table());
+                static_cast<table_relation &>(new_facts).add_table_fact(fact);
+            }
+            else {
+                get_rmanager().reset_saturated_marks();
+            }
             table_relation & rel = static_cast<table_relation &>(rel0);
             rel.add_table_fact(fact);
             // TODO: table facts?
@@ -574,6 +811,40 @@ namespace datalog {
         }
     }
 
+    void rel_context::load_table_facts(func_decl* pred, char const* file_name) {
+        relation_manager & rm = get_rmanager();
+        relation_base & rel0 = get_relation(pred);
+        table_plugin * p = rm.get_table_plugin(symbol("mapped"));
+        if (rel0.from_table() && !m_incr_rules) {
+            rm.reset_saturated_marks();
+            table_base & t = static_cast<table_relation &>(rel0).get_table();
+            if (&t.get_plugin() == p) {
+                // a sorted file is read into the run of an empty table without merging
+                mapped_table_plugin::get(t).load(file_name);
+                return;
+            }
+            scoped_rel<table_base> facts = p->mk_empty(t.get_signature());
+            mapped_table_plugin::get(*facts).load(file_name);
+            scoped_ptr<table_union_fn> fn = rm.mk_union_fn(t, *facts, 0);
+            (*fn)(t, *facts, 0);
+            return;
+        }
+        relation_signature rsig;
+        table_signature tsig;
+        rm.from_predicate(pred, rsig);
+        if (!rm.relation_signature_to_table(rsig, tsig)) {
+            throw default_exception("table files cannot be loaded into relations over infinite sorts");
+        }
+        scoped_rel<table_base> facts = p->mk_empty(tsig);
+        mapped_table_plugin::get(*facts).load(file_name);
+        table_fact fact;
+        table_base::iterator it = facts->begin(), end = facts->end();
+        for (; it != end; ++it) {
+            it->get_fact(fact);
+            add_fact(pred, fact);
+        }
+    }
+
     bool rel_context::has_facts(func_decl * pred) const {
         relation_base* r = try_get_relation(pred);
         return r && !r->empty();
@@ -43,9 +43,35 @@ namespace datalog {
         instruction_block  m_code;
         double             m_sw;
 
+        // incremental evaluation (datalog.incremental)
+        scoped_ptr<rule_set> m_incr_rules;      // transformed rules of the last query
+        rule_ref_vector      m_incr_source;     // rules that m_incr_rules was obtained from
+        ast_ref_vector       m_incr_query;      // query or output predicates of the last query
+        func_decl_ref        m_incr_query_pred;
+        bool                 m_incr_reuse;      // the current query runs the cached rules
+        obj_map<func_decl, relation_base*> m_new_facts; // facts added since the last query
+        func_decl_set        m_incr_empty;      // predicates without facts when the rules were transformed
+
         class scoped_query;
 
         void reset_negated_tables();
+
+        /**
+           \brief Return true if the cached rules were obtained from the current rules for 
+           a query given by \c query.
+        */
+        bool can_reuse_rules(unsigned sz, ast * const * query) const;
+        void save_rules(rule_set const & source, unsigned sz, ast * const * query, func_decl * query_pred);
+        void reset_incremental();
+        relation_base & get_new_facts(func_decl * pred);
+
+        /**
+           \brief Record the predicates of the current rules that have no facts. Rule
+           transformations such as the bottom-up cone of influence filter and magic sets
+           depend on which relations are empty, so the cached rules cannot be reused once
+           one of these predicates receives a fact.
+        */
+        void collect_empty_predicates();
         
         relation_plugin & get_ordinary_relation_plugin(symbol relation_name);
         
@@ -105,6 +131,7 @@ namespace datalog {
         */
         virtual void add_fact(func_decl* pred, relation_fact const& fact);
         virtual void add_fact(func_decl* pred, table_fact const& fact);
+        virtual void load_table_facts(func_decl* pred, char const* file_name);
 
         /** \brief check if facts were added to relation
         */
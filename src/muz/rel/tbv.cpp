@@ -215,19 +215,7 @@ bool tbv_manager::set_and(tbv& dst,  tbv const& src) const {
 }
 
 bool tbv_manager::is_well_formed(tbv const& dst) const {
-    unsigned nw = m.num_words();
-    unsigned w;
-    for (unsigned i = 0; i + 1 < nw; ++i) {
-        w = dst.get_word(i);
-        w = w | (w << 1) | 0x55555555;
-        if (w != 0xFFFFFFFF) return false;
-    }
-    if (nw > 0) {        
-        w = m.last_word(dst);
-        w = w | (w << 1) | 0x55555555 | ~m.get_mask();
-        if (w != 0xFFFFFFFF) return false;
-    }
-    return true;
+    return m.all_pairs_nonzero(dst);
 }
 
 void tbv_manager::complement(tbv const& src, ptr_vector<tbv>& result) {
@@ -43,7 +43,7 @@ class tbv_manager {
     fixed_bit_vector_manager m;
     ptr_vector<tbv> allocated_tbvs;
 public:
-    tbv_manager(unsigned n): m(2*n) {}
+    tbv_manager(unsigned n, bool use_simd = true): m(2*n, use_simd) {}
     ~tbv_manager();
     void reset();
     tbv* allocate();
@@ -63,6 +63,7 @@ public:
         
     void copy(tbv& dst, tbv const& src) const;
     unsigned num_tbits() const { return m.num_bits()/2; }
+    unsigned simd_level() const { return m.simd_level(); }
     tbv& reset(tbv& bv) const { return fill0(bv); }
     tbv& fill0(tbv& bv) const;
     tbv& fill1(tbv& bv) const;
@@ -524,10 +524,21 @@ namespace datalog {
                 }
             }
         } else {
+            // the indices pay off when more than a few elements are inserted.
+            bool use_index = src.size() >= 4;
+            udoc::index dst_idx(dm, dst);
+            scoped_ptr<udoc::index> delta_idx;
+            if (delta && !deltaempty && use_index) {
+                delta_idx = alloc(udoc::index, dm, *delta);
+            }
             for (unsigned i = 0; i < src.size(); ++i) {
-                if (dst.insert(dm, dm.allocate(src[i])) && delta) {
+                doc* d = dm.allocate(src[i]);
+                bool is_new = use_index ? dst_idx.insert(d) : dst.insert(dm, d);
+                if (is_new && delta) {
                     if (deltaempty)
                         delta->push_back(dm.allocate(src[i]));
+                    else if (delta_idx)
+                        delta_idx->insert(dm.allocate(src[i]));
                     else
                         delta->insert(dm, dm.allocate(src[i]));
                 }
@@ -31,13 +31,24 @@ namespace nlsat {
     class assignment : public polynomial::var2anum {
         scoped_anum_vector m_values;
         svector<bool>      m_assigned;
+        unsigned_vector    m_stamps;   // m_stamps[x] changes whenever x is assigned or unassigned.
+        unsigned           m_stamp;
+
+        void touch(var x) { m_stamps.reserve(x+1, 0); m_stamps[x] = ++m_stamp; }
+        void touch_all() {
+            m_stamps.reserve(m_values.size(), 0);
+            for (unsigned i = 0; i < m_stamps.size(); ++i) 
+                m_stamps[i] = ++m_stamp;
+        }
     public:
-        assignment(anum_manager & _m):m_values(_m) {}
+        assignment(anum_manager & _m):m_values(_m), m_stamp(0) {}
         virtual ~assignment() {}
         anum_manager & am() const { return m_values.m(); }
         void swap(assignment & other) {
             m_values.swap(other.m_values);
             m_assigned.swap(other.m_assigned);
+            touch_all();
+            other.touch_all();
         }
         void copy(assignment const& other) {
             m_assigned.reset();
@@ -48,6 +59,7 @@ namespace nlsat {
                     am().set(m_values[i], other.value(i));
                 }
             }
+            touch_all();
         }
 
         void set_core(var x, anum & v) {
@@ -55,16 +67,23 @@ namespace nlsat {
             m_assigned.reserve(x+1, false); 
             m_assigned[x] = true;
             am().swap(m_values[x], v); 
+            touch(x);
         }
         void set(var x, anum const & v) {
             m_values.reserve(x+1, anum());
             m_assigned.reserve(x+1, false); 
             m_assigned[x] = true;
             am().set(m_values[x], v); 
+            touch(x);
         }
-        void reset(var x) { if (x < m_assigned.size()) m_assigned[x] = false; }
-        void reset() { m_assigned.reset(); }
+        void reset(var x) { if (x < m_assigned.size()) { m_assigned[x] = false; touch(x); } }
+        void reset() { m_assigned.reset(); touch_all(); }
         bool is_assigned(var x) const { return m_assigned.get(x, false); }
+        /**
+           \brief Return a number that identifies the current value of x: it is
+           the same for two calls only if x was not assigned in between.
+        */
+        unsigned stamp(var x) const { return m_stamps.get(x, 0); }
         anum const & value(var x) const { return m_values[x]; }
         virtual anum_manager & m() const { return am(); }
         virtual bool contains(var x) const { return is_assigned(x); }
@@ -73,6 +92,8 @@ namespace nlsat {
             SASSERT(x < m_values.size() && y < m_values.size());
             std::swap(m_assigned[x], m_assigned[y]);
             std::swap(m_values[x], m_values[y]);
+            touch(x);
+            touch(y);
         }
         void display(std::ostream& out) const {
             for (unsigned i = 0; i < m_assigned.size(); ++i) {
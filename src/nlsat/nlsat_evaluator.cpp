@@ -359,6 +359,30 @@ namespace nlsat {
 
         sign_table m_sign_table_tmp;
 
+        /**
+           \brief Roots of p in x isolated under a partial assignment. They only
+           depend on the values of the other variables of p, so the entry is 
+           valid as long as their assignment stamps did not change, or they 
+           were assigned the same rational values again after a backjump.
+        */
+        struct root_entry {
+            poly *          m_p;
+            var             m_x;
+            var_vector      m_vars;     // variables of p other than x.
+            unsigned_vector m_stamps;   // their stamps when the roots were isolated.
+            anum_vector     m_values;   // their values.
+            anum_vector     m_roots;
+            svector<int>    m_signs;
+            bool            m_has_signs;
+            root_entry *    m_next;     // entry of the same polynomial for another variable.
+        };
+        ptr_vector<root_entry>   m_root_cache;        // polynomial id -> entries
+        unsigned                 m_root_cache_size;
+        bool                     m_use_root_cache;
+        var_vector               m_vars_tmp;
+        unsigned                 m_root_cache_hits;
+        unsigned                 m_root_cache_misses;
+
         imp(solver& s, assignment const & x2v, pmanager & pm, small_object_allocator & allocator):
             m_solver(s),
             m_assignment(x2v),
@@ -369,9 +393,138 @@ namespace nlsat {
             m_tmp_values(m_am),
             m_add_roots_tmp(m_am),
             m_inf_tmp(m_am),
-            m_sign_table_tmp(m_am) {
+            m_sign_table_tmp(m_am),
+            m_root_cache_size(0),
+            m_use_root_cache(true) {
+            reset_statistics();
+        }
+
+        ~imp() {
+            reset_root_cache();
         }
 
+        void del_values(anum_vector & vs) {
+            for (unsigned i = 0; i < vs.size(); ++i) 
+                m_am.del(vs[i]);
+            vs.reset();
+        }
+
+        void reset_root_cache() {
+            for (unsigned i = 0; i < m_root_cache.size(); ++i) {
+                root_entry * e = m_root_cache[i];
+                while (e) {
+                    root_entry * next = e->m_next;
+                    del_values(e->m_values);
+                    del_values(e->m_roots);
+                    m_pm.dec_ref(e->m_p);
+                    dealloc(e);
+                    e = next;
+                }
+            }
+            m_root_cache.reset();
+            m_root_cache_size = 0;
+        }
+
+        void reset_statistics() {
+            m_root_cache_hits   = 0;
+            m_root_cache_misses = 0;
+        }
+
+        void collect_statistics(statistics & st) const {
+            st.update("nlsat root cache hits", m_root_cache_hits);
+            st.update("nlsat root cache misses", m_root_cache_misses);
+        }
+
+        bool is_current(root_entry & e) {
+            for (unsigned i = 0; i < e.m_vars.size(); ++i) {
+                var y = e.m_vars[i];
+                if (!m_assignment.is_assigned(y)) 
+                    return false;
+                if (m_assignment.stamp(y) == e.m_stamps[i]) 
+                    continue;
+                anum const & v = m_assignment.value(y);
+                if (!m_am.is_rational(v) || !m_am.is_rational(e.m_values[i]) || !m_am.eq(v, e.m_values[i]))
+                    return false;
+                e.m_stamps[i] = m_assignment.stamp(y);
+            }
+            return true;
+        }
+
+        /**
+           \brief Isolate the roots of p in x, where every other variable of p is
+           assigned, reusing the roots of an earlier call when they still apply.
+        */
+        void isolate_roots(poly * p, var x, scoped_anum_vector & roots, svector<int> * signs) {
+            if (!m_use_root_cache) {
+                if (signs) 
+                    m_am.isolate_roots(polynomial_ref(p, m_pm), undef_var_assignment(m_assignment, x), roots, *signs);
+                else
+                    m_am.isolate_roots(polynomial_ref(p, m_pm), undef_var_assignment(m_assignment, x), roots);
+                return;
+            }
+            unsigned id = m_pm.id(p);
+            root_entry * e = m_root_cache.get(id, 0);
+            while (e && (e->m_p != p || e->m_x != x)) 
+                e = e->m_next;
+            if (e && (!signs || e->m_has_signs) && is_current(*e)) {
+                m_root_cache_hits++;
+                for (unsigned i = 0; i < e->m_roots.size(); ++i) 
+                    roots.push_back(e->m_roots[i]);
+                if (signs) 
+                    signs->append(e->m_signs);
+                return;
+            }
+            m_root_cache_misses++;
+            svector<int> signs_tmp;
+            svector<int> & ss = signs ? *signs : signs_tmp;
+            unsigned num_roots = roots.size(), num_signs = ss.size();
+            if (signs) 
+                m_am.isolate_roots(polynomial_ref(p, m_pm), undef_var_assignment(m_assignment, x), roots, ss);
+            else
+                m_am.isolate_roots(polynomial_ref(p, m_pm), undef_var_assignment(m_assignment, x), roots);
+            m_vars_tmp.reset();
+            m_pm.vars(p, m_vars_tmp);
+            for (unsigned i = 0; i < m_vars_tmp.size(); ++i) {
+                if (m_vars_tmp[i] != x && !m_assignment.is_assigned(m_vars_tmp[i]))
+                    return;
+            }
+            if (m_root_cache_size >= max_root_cache_size) {
+                reset_root_cache();
+            }
+            if (!e) {
+                e = alloc(root_entry);
+                e->m_p = p;
+                e->m_x = x;
+                m_pm.inc_ref(p);
+                m_root_cache.reserve(id + 1, 0);
+                e->m_next = m_root_cache[id];
+                m_root_cache[id] = e;
+                m_root_cache_size++;
+            }
+            e->m_vars.reset();
+            e->m_stamps.reset();
+            del_values(e->m_values);
+            del_values(e->m_roots);
+            for (unsigned i = 0; i < m_vars_tmp.size(); ++i) {
+                var y = m_vars_tmp[i];
+                if (y == x) 
+                    continue;
+                e->m_vars.push_back(y);
+                e->m_stamps.push_back(m_assignment.stamp(y));
+                e->m_values.push_back(anum());
+                m_am.set(e->m_values.back(), m_assignment.value(y));
+            }
+            for (unsigned i = num_roots; i < roots.size(); ++i) {
+                e->m_roots.push_back(anum());
+                m_am.set(e->m_roots.back(), roots[i]);
+            }
+            e->m_signs.reset();
+            e->m_signs.append(ss.size() - num_signs, ss.c_ptr() + num_signs);
+            e->m_has_signs = signs != 0;
+        }
+
+        static const unsigned max_root_cache_size = 10000;
+
         var max_var(poly const * p) const {
             return m_pm.max_var(p);
         }
@@ -422,7 +575,7 @@ namespace nlsat {
             atom::kind k = a->get_kind();
             scoped_anum_vector & roots = m_tmp_values;
             roots.reset();
-            m_am.isolate_roots(polynomial_ref(a->p(), m_pm), undef_var_assignment(m_assignment, a->x()), roots);
+            isolate_roots(a->p(), a->x(), roots, 0);
             TRACE("nlsat",
                   m_solver.display(tout << (neg?"!":""), *a); tout << "\n";
                   if (roots.empty()) {
@@ -464,7 +617,7 @@ namespace nlsat {
                 TRACE("nlsat_evaluator", tout << "x: " << x << " max_var(p): " << m_pm.max_var(p) << "\n";);
                 // Note: I added undef_var_assignment in the following statement, to allow us to obtain the infeasible interval sets
                 // even when the maximal variable is assigned. I need this feature to minimize conflict cores.
-                m_am.isolate_roots(polynomial_ref(p, m_pm), undef_var_assignment(m_assignment, x), roots, signs);
+                isolate_roots(p, x, roots, &signs);
                 t.add(roots, signs);
             }
         }
@@ -602,7 +755,7 @@ namespace nlsat {
             var x = a->max_var();
             // Note: I added undef_var_assignment in the following statement, to allow us to obtain the infeasible interval sets
             // even when the maximal variable is assigned. I need this feature to minimize conflict cores.
-            m_am.isolate_roots(polynomial_ref(a->p(), m_pm), undef_var_assignment(m_assignment, x), roots);
+            isolate_roots(a->p(), x, roots, 0);
             interval_set_ref result(m_ism);
 
             if (i > roots.size()) {
@@ -687,6 +840,28 @@ namespace nlsat {
         return m_imp->infeasible_intervals(a, neg);
     }
 
+    void evaluator::isolate_roots(poly * p, var x, scoped_anum_vector & roots) {
+        m_imp->isolate_roots(p, x, roots, 0);
+    }
+
+    void evaluator::set_root_cache(bool f) {
+        m_imp->m_use_root_cache = f;
+        if (!f) 
+            m_imp->reset_root_cache();
+    }
+
+    void evaluator::reset_root_cache() {
+        m_imp->reset_root_cache();
+    }
+
+    void evaluator::collect_statistics(statistics & st) const {
+        m_imp->collect_statistics(st);
+    }
+
+    void evaluator::reset_statistics() {
+        m_imp->reset_statistics();
+    }
+
     void evaluator::push() {
         // do nothing
     }
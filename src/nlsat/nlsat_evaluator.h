@@ -23,6 +23,7 @@ Revision History:
 #include"nlsat_types.h"
 #include"nlsat_assignment.h"
 #include"nlsat_interval_set.h"
+#include"statistics.h"
 
 namespace nlsat {
 
@@ -54,6 +55,24 @@ namespace nlsat {
         */
         interval_set_ref infeasible_intervals(atom * a, bool neg);
 
+        /**
+           \brief Store in roots the roots of p in x, when every other variable
+           of p is assigned in the current model. The value of x is ignored.
+           The roots are cached for the values of the other variables.
+        */
+        void isolate_roots(poly * p, var x, scoped_anum_vector & roots);
+
+        void set_root_cache(bool f);
+
+        /**
+           \brief Forget the cached roots. The cache is keyed by polynomial and
+           variable, so it must be reset when the variables are renamed.
+        */
+        void reset_root_cache();
+
+        void collect_statistics(statistics & st) const;
+        void reset_statistics();
+
         void push();
         void pop(unsigned num_scopes);
     };
@@ -901,7 +901,7 @@ namespace nlsat {
                 roots.reset();
                 // Variable y is assigned in m_assignment. We must temporarily unassign it.
                 // Otherwise, the isolate_roots procedure will assume p is a constant polynomial.
-                m_am.isolate_roots(p, undef_var_assignment(m_assignment, y), roots);
+                m_evaluator.isolate_roots(p, y, roots);
                 unsigned num_roots = roots.size();
                 for (unsigned i = 0; i < num_roots; i++) {
                     TRACE("nlsat_explain", tout << "comparing root: "; m_am.display_decimal(tout, roots[i]); tout << "\n";);
@@ -1618,7 +1618,7 @@ namespace nlsat {
                 p = ps.get(i);
                 scoped_anum_vector & roots = m_roots_tmp;
                 roots.reset();
-                m_am.isolate_roots(p, undef_var_assignment(m_assignment, x), roots);
+                m_evaluator.isolate_roots(p, x, roots);
                 bool glb_valid = false, lub_valid = false;
                 for (unsigned j = 0; j < roots.size(); ++j) {
                     int s = m_am.compare(x_val, roots[j]);
@@ -1772,7 +1772,7 @@ namespace nlsat {
                 p = m_ps.get(i);
                 scoped_anum_vector & roots = m_roots_tmp;
                 roots.reset();
-                m_am.isolate_roots(p, undef_var_assignment(m_assignment, x), roots);
+                m_evaluator.isolate_roots(p, x, roots);
                 for (unsigned j = 0; j < roots.size(); ++j) {
                     int s = m_am.compare(x_val, roots[j]);
                     if (s <= 0 && (unbounded || m_am.compare(roots[j], val) <= 0)) {
@@ -202,6 +202,7 @@ namespace nlsat {
             m_max_conflicts  = p.max_conflicts();
             m_random_order   = p.shuffle_vars();
             m_random_seed    = p.seed();
+            m_evaluator.set_root_cache(p.root_cache());
             m_ism.set_seed(m_random_seed);
             m_explain.set_simplify_cores(m_simplify_cores);
             m_explain.set_minimize_cores(min_cores);
@@ -1798,6 +1799,8 @@ namespace nlsat {
             st.update("nlsat decisions", m_decisions);
             st.update("nlsat stages", m_stages);
             st.update("nlsat irrational assignments", m_irrational_assignments);
+            m_evaluator.collect_statistics(st);
+            m_am.collect_statistics(st);
         }
 
         void reset_statistics() {
@@ -1806,6 +1809,8 @@ namespace nlsat {
             m_decisions              = 0;
             m_stages                 = 0;
             m_irrational_assignments = 0;
+            m_evaluator.reset_statistics();
+            m_am.reset_statistics();
         }
 
         // -----------------------
@@ -1989,6 +1994,7 @@ namespace nlsat {
                 }
             });
             m_pm.rename(sz, p);
+            m_evaluator.reset_root_cache();
             del_ill_formed_lemmas();
             TRACE("nlsat_bool_assignment_bug", tout << "before reinit cache\n"; display_bool_assignment(tout););
             reinit_cache();
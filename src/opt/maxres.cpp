@@ -64,6 +64,9 @@ Notes:
 #include "opt_params.hpp"
 #include "ast_util.h"
 #include "smt_solver.h"
+#include "ast_translation.h"
+#include "scoped_ptr_vector.h"
+#include "z3_omp.h"
 
 using namespace opt;
 
@@ -77,6 +80,8 @@ private:
     struct stats {
         unsigned m_num_cores;
         unsigned m_num_cs;
+        unsigned m_num_parallel_cores;
+        unsigned m_num_hardened;
         stats() { reset(); }
         void reset() {
             memset(this, 0, sizeof(*this));
@@ -109,9 +114,54 @@ private:
     bool             m_pivot_on_cs;            // prefer smaller correction set to core.
     bool             m_dump_benchmarks;        // display benchmarks (into wcnf format)
 
+    bool             m_harden;                 // assert soft constraints that no improving solution falsifies
+    unsigned         m_num_threads;            // threads extracting cores in parallel
+    bool             m_sat_core_guided;        // use the MaxSAT engine of the SAT core when it is enabled
+    bool             m_sat_exhaust_cores;      // exhaust cores in the MaxSAT engine of the SAT core
+    bool             m_sat_solved;             // last call was solved by the MaxSAT engine of the SAT core
+    statistics       m_sat_stats;
+
     std::string      m_trace_id;
     typedef ptr_vector<expr> exprs;
 
+    /**
+       \brief Copy of the solver used by a thread that extracts cores in parallel.
+    */
+    struct core_worker {
+        ast_manager             m;
+        ref<solver>             m_solver;
+        expr_ref_vector         m_asms;
+        vector<expr_ref_vector> m_cores;
+        core_worker(ast_manager& m0): m(m0, true), m_asms(m) {}
+
+        // find disjoint cores among m_asms, in the order of m_asms.
+        void extract_cores(unsigned max_num_cores, unsigned max_core_size) {
+            m_cores.reset();
+            ptr_vector<expr> core;
+            while (m_cores.size() < max_num_cores && 
+                   m_solver->check_sat(m_asms.size(), m_asms.c_ptr()) == l_false) {
+                core.reset();
+                m_solver->get_unsat_core(core);
+                if (core.empty()) {
+                    break;
+                }
+                m_cores.push_back(expr_ref_vector(m, core.size(), core.c_ptr()));
+                if (core.size() >= max_core_size) {
+                    break;
+                }
+                for (unsigned i = 0; i < m_asms.size(); ++i) {
+                    if (core.contains(m_asms[i].get())) {
+                        m_asms[i] = m_asms.back();
+                        m_asms.pop_back();
+                        --i;
+                    }
+                }
+            }
+        }
+    };
+    scoped_ptr_vector<core_worker> m_workers;
+    unsigned         m_num_synced;             // number of assertions of s() copied to the workers
+
 public:
     maxres(maxsat_context& c, unsigned index, 
            weights_t& ws, expr_ref_vector const& soft, 
@@ -132,7 +182,13 @@ public:
         m_max_core_size(3),
         m_maximize_assignment(false),
         m_max_correction_set_size(3),
-        m_pivot_on_cs(true)
+        m_pivot_on_cs(true),
+        m_harden(false),
+        m_num_threads(1),
+        m_sat_core_guided(true),
+        m_sat_exhaust_cores(true),
+        m_sat_solved(false),
+        m_num_synced(0)
     {
         switch(st) {
         case s_primal:
@@ -201,6 +257,7 @@ public:
                   tout << "\n";
                   display(tout);
                   );
+            harden();
             is_sat = check_sat_hill_climb(m_asms);
             if (m.canceled()) {
                 return l_undef;
@@ -234,6 +291,7 @@ public:
         trace();
         exprs cs;
         while (m_lower < m_upper) {
+            harden();
             lbool is_sat = check_sat_hill_climb(m_asms);
             if (m.canceled()) {
                 return l_undef;
@@ -270,6 +328,28 @@ public:
     }
 
 
+    /**
+       \brief Falsifying a soft constraint of weight w costs at least m_lower + w.
+       If that exceeds the cost of the best assignment found, every better assignment
+       satisfies it, so it becomes a hard constraint. With the weight-ordered
+       hill climbing this settles the high-weight strata first.
+    */
+    void harden() {
+        if (!m_harden) return;
+        rational gap = m_upper - m_lower;
+        for (unsigned i = 0; i < m_asms.size(); ++i) {
+            expr* a = m_asms[i].get();
+            if (get_weight(a) > gap) {
+                s().assert_expr(a);
+                m_defs.push_back(a);
+                ++m_stats.m_num_hardened;
+                m_asms[i] = m_asms.back();
+                m_asms.pop_back();
+                --i;
+            }
+        }
+    }
+
     lbool check_sat_hill_climb(expr_ref_vector& asms1) {
         expr_ref_vector asms(asms1);
         lbool is_sat = l_true;
@@ -329,10 +409,68 @@ public:
         SASSERT(upper == m_lower);
         m_upper = m_lower;
         m_found_feasible_optimum = true;
+        m_c.model_updated(m_model.get());
+    }
+
+    /**
+       \brief Solve with the core-guided MaxSAT engine of the SAT core, which relaxes
+       cores with totalizers over the literals of the soft constraints instead of
+       asserting new formulas. Return l_undef, without changing the state, when
+       the engine does not apply to the soft constraints.
+    */
+    lbool sat_solver_maxsat() {
+        if (!init()) return l_undef;
+        // the engine assumes literals, so other soft constraints get a definition.
+        // so does a literal whose complement is already assumed, since the
+        // assumptions are internalized together.
+        expr_ref_vector asms(m);
+        obj_hashtable<expr> pos, neg;
+        for (unsigned i = 0; i < m_soft.size(); ++i) {
+            expr* e = m_soft[i], *a = e;
+            bool is_neg = m.is_not(e, a);
+            if (is_literal(e) && !(is_neg ? pos : neg).contains(a)) {
+                (is_neg ? neg : pos).insert(a);
+                asms.push_back(e);
+            }
+            else {
+                asms.push_back(mk_fresh_bool("soft"));
+                s().assert_expr(m.mk_iff(asms.back(), e));
+            }
+        }
+        rational lower, upper;
+        lbool is_sat = inc_sat_maxsat(s(), asms.size(), asms.c_ptr(), m_weights.c_ptr(), 
+                                      m_sat_exhaust_cores, lower, upper, m_sat_stats);
+        if (is_sat != l_true) {
+            if (m.canceled() && lower > m_lower) {
+                m_lower = lower;
+            }
+            return is_sat;
+        }
+        m_sat_solved = true;
+        s().get_model(m_model);
+        upper.reset();
+        for (unsigned i = 0; i < m_soft.size(); ++i) {
+            m_assignment[i] = is_true(m_soft[i]);
+            if (!m_assignment[i]) {
+                upper += m_weights[i];
+            }
+        }
+        SASSERT(upper == lower);
+        m_lower = m_upper = upper;
+        trace();
+        m_c.model_updated(m_model.get());
+        return l_true;
     }
 
     virtual lbool operator()() {
         m_defs.reset();
+        m_sat_solved = false;
+        if (m_st == s_primal && m_sat_core_guided && m_c.sat_enabled()) {
+            lbool is_sat = sat_solver_maxsat();
+            if (is_sat != l_undef || m.canceled()) {
+                return is_sat;
+            }
+        }
         switch(m_st) {
         case s_primal:
             return mus_solver();
@@ -345,6 +483,135 @@ public:
     virtual void collect_statistics(statistics& st) const { 
         st.update("maxres-cores", m_stats.m_num_cores);
         st.update("maxres-correction-sets", m_stats.m_num_cs);
+        st.update("maxres-parallel-cores", m_stats.m_num_parallel_cores);
+        st.update("maxres-hardened", m_stats.m_num_hardened);
+        st.copy(m_sat_stats);
+    }
+
+    /**
+       \brief Create the worker solvers, or assert in them what was asserted
+       in s() since the last call. Return false if the solver cannot be copied.
+       The SAT solver is translated; the SMT solver of the optimization context 
+       cannot be, so its assertions are copied into fresh SMT solvers.
+    */
+    bool sync_workers() {
+        unsigned n = s().get_num_assertions();
+        if (m_workers.size() != m_num_threads || n < m_num_synced) {
+            m_workers.reset();
+            try {
+                for (unsigned i = 0; i < m_num_threads; ++i) {
+                    core_worker* w = alloc(core_worker, m);
+                    m_workers.push_back(w);
+                    if (m_c.sat_enabled()) {
+                        w->m_solver = s().translate(w->m, m_params);
+                        continue;
+                    }
+                    w->m_solver = mk_smt_solver(w->m, m_params, symbol::null);
+                    ast_translation tr(m, w->m);
+                    for (unsigned j = 0; j < n; ++j) {
+                        w->m_solver->assert_expr(tr(s().get_assertion(j)));
+                    }
+                }
+            }
+            catch (z3_exception& ex) {
+                IF_VERBOSE(1, verbose_stream() << "(opt.maxres cannot copy solver: " << ex.msg() << ")\n";);
+                m_workers.reset();
+                m_num_threads = 1;
+                return false;
+            }
+            m_num_synced = n;
+            return true;
+        }
+        for (unsigned j = 0; j < m_workers.size(); ++j) {
+            ast_translation tr(m, m_workers[j]->m);
+            for (unsigned i = m_num_synced; i < n; ++i) {
+                m_workers[j]->m_solver->assert_expr(tr(s().get_assertion(i)));
+            }
+        }
+        m_num_synced = n;
+        return true;
+    }
+
+    /**
+       \brief Extract further cores among asms with the worker solvers, each trying the
+       soft constraints in a different order (the first by decreasing weight, the others
+       shuffled). The cores that are disjoint from each other and from the cores found so
+       far are minimized and added to cores. Return false if the workers could not run.
+    */
+    bool get_cores_parallel(expr_ref_vector const& asms, vector<exprs>& cores) {
+#ifdef _NO_OMP_
+        return false;
+#else
+        if (omp_in_parallel() || !sync_workers()) {
+            return false;
+        }
+        expr_ref_vector sorted(asms);
+        sort_assumptions(sorted);
+        for (unsigned j = 0; j < m_workers.size(); ++j) {
+            core_worker& w = *m_workers[j];
+            ast_translation tr(m, w.m);
+            w.m_asms.reset();
+            for (unsigned i = 0; i < sorted.size(); ++i) {
+                w.m_asms.push_back(tr(sorted[i].get()));
+            }
+            random_gen rand(j);
+            for (unsigned i = w.m_asms.size(); j > 0 && i > 1; --i) {
+                unsigned k = rand(i);
+                expr_ref tmp(w.m_asms[i - 1].get(), w.m);
+                w.m_asms[i - 1] = w.m_asms[k].get();
+                w.m_asms[k] = tmp;
+            }
+            m.limit().push_child(&w.m.limit());
+        }
+        unsigned max_num_cores = m_max_num_cores - cores.size();
+        int num_workers = static_cast<int>(m_workers.size());
+        #pragma omp parallel for num_threads(num_workers)
+        for (int j = 0; j < num_workers; ++j) {
+            try {
+                m_workers[j]->extract_cores(max_num_cores, m_max_core_size);
+            }
+            catch (z3_exception&) {
+                // canceled: the cores found so far remain valid.
+            }
+        }
+        for (unsigned j = 0; j < m_workers.size(); ++j) {
+            m.limit().pop_child();
+        }
+        if (m.canceled()) {
+            return true;
+        }
+
+        obj_hashtable<expr> used;
+        for (unsigned i = 0; i < cores.size(); ++i) {
+            for (unsigned k = 0; k < cores[i].size(); ++k) {
+                used.insert(cores[i][k]);
+            }
+        }
+        exprs core;
+        for (unsigned j = 0; j < m_workers.size(); ++j) {
+            core_worker& w = *m_workers[j];
+            ast_translation tr(w.m, m);
+            for (unsigned i = 0; i < w.m_cores.size() && cores.size() < m_max_num_cores; ++i) {
+                core.reset();
+                bool disjoint = true;
+                for (unsigned k = 0; disjoint && k < w.m_cores[i].size(); ++k) {
+                    expr* e = tr(w.m_cores[i][k].get());
+                    disjoint = !used.contains(e);
+                    core.push_back(e);
+                }
+                if (!disjoint || minimize_core(core) != l_true || core.empty()) {
+                    continue;
+                }
+                for (unsigned k = 0; k < core.size(); ++k) {
+                    used.insert(core[k]);
+                }
+                cores.push_back(core);
+                ++m_stats.m_num_cores;
+                ++m_stats.m_num_parallel_cores;
+            }
+        }
+        return true;
+#endif
     }
 
     lbool get_cores(vector<exprs>& cores) {
@@ -379,6 +646,12 @@ public:
                 break;
             }
             remove_soft(core, asms);
+            if (m_num_threads > 1 && get_cores_parallel(asms, cores)) {
+                if (m.canceled()) {
+                    is_sat = l_undef;
+                }
+                break;
+            }
             is_sat = check_sat_hill_climb(asms);
         }
         TRACE("opt", 
@@ -744,6 +1017,7 @@ public:
 
         m_upper = upper;
         trace();
+        m_c.model_updated(mdl);
 
         add_upper_bound_block();
 
@@ -809,6 +1083,10 @@ public:
         m_pivot_on_cs = _p.maxres_pivot_on_correction_set();
         m_wmax = _p.maxres_wmax();
         m_dump_benchmarks = _p.dump_benchmarks();
+        m_harden = _p.maxres_harden();
+        m_num_threads = std::max(1u, _p.maxres_threads());
+        m_sat_core_guided = _p.maxres_sat_core_guided();
+        m_sat_exhaust_cores = _p.maxres_sat_exhaust_cores();
     }
 
     void init_local() {
@@ -827,7 +1105,10 @@ public:
     }
 
     virtual void commit_assignment() {
-        if (m_found_feasible_optimum) {
+        if (m_sat_solved) {
+            maxsmt_solver_base::commit_assignment();
+        }
+        else if (m_found_feasible_optimum) {
             TRACE("opt", tout << "Committing feasible solution\n";
                   tout << m_defs;
                   tout << m_asms;
@@ -32,9 +32,27 @@ Notes:
 #include "opt_params.hpp"
 #include "model_smt2_pp.h"
 
+/**
+   \brief Optimization context of the command interpreter. With opt.dump_models
+   it displays every model that improves the objectives while optimizing.
+*/
+class cmd_opt_context : public opt::context, public opt::on_model_callback {
+    cmd_context& m_cmd;
+public:
+    cmd_opt_context(cmd_context& cmd): opt::context(cmd.m()), m_cmd(cmd) {
+        set_on_model(this);
+    }
+    virtual void on_model(model_ref& mdl) {
+        opt_params p(get_params());
+        if (p.dump_models()) {
+            m_cmd.display_model(mdl);
+        }
+    }
+};
+
 static opt::context& get_opt(cmd_context& cmd) {
     if (!cmd.get_opt()) {
-        cmd.set_opt(alloc(opt::context, cmd.m()));
+        cmd.set_opt(alloc(cmd_opt_context, cmd));
     }
     return dynamic_cast<opt::context&>(*cmd.get_opt());
 }
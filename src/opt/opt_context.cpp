@@ -42,6 +42,9 @@ Notes:
 #include "filter_model_converter.h"
 #include "ast_pp_util.h"
 #include "inc_sat_solver.h"
+#include "ast_translation.h"
+#include "pb_sls.h"
+#include "z3_omp.h"
 
 namespace opt {
 
@@ -126,14 +129,23 @@ namespace opt {
         m_hard_constraints(m),
         m_solver(0),
         m_box_index(UINT_MAX),
-        m_optsmt(m),
+        m_optsmt(m, *this),
         m_scoped_state(m),
         m_fm(m),
         m_objective_refs(m),
         m_enable_sat(false),
         m_is_clausal(false),
         m_pp_neat(false),
-        m_unknown("unknown")
+        m_unknown("unknown"),
+        m_on_model(0),
+        m_anytime_sls(false),
+        m_sls(0),
+        m_sls_decls(m),
+        m_incremental(false),
+        m_reuse_solver(false),
+        m_solver_hard(m),
+        m_purified_trail(m),
+        m_warm_trail(m)
     {
         params_ref p;
         p.set_bool("model", true);
@@ -233,34 +245,75 @@ namespace opt {
             return execute_box();
         }
         clear_state();
-        init_solver(); 
+        bool reuse = m_incremental && m_reuse_solver;
+        if (!reuse) {
+            init_solver(); 
+        }
         import_scoped_state(); 
         normalize();
         internalize();
-        update_solver();
+        if (reuse && !can_reuse_solver()) {
+            IF_VERBOSE(1, verbose_stream() << "(optimize:reset-solver)\n";);
+            init_solver();
+            reuse = false;
+        }
+        if (!reuse) {
+            update_solver();
+        }
         solver& s = get_solver();
-        s.assert_expr(m_hard_constraints);
+        assert_hard_constraints(s);
         display_benchmark();
         IF_VERBOSE(1, verbose_stream() << "(optimize:check-sat)\n";);
-        lbool is_sat = s.check_sat(0,0);
+        lbool is_sat = reuse ? check_warm(s) : s.check_sat(0,0);
         TRACE("opt", tout << "initial search result: " << is_sat << "\n";);
         if (is_sat != l_false) {
             s.get_model(m_model);
             s.get_labels(m_labels);
         }
+        // the solver only holds hard constraints so far.
+        m_reuse_solver = m_incremental;
         if (is_sat != l_true) {
             return is_sat;
         }
         IF_VERBOSE(1, verbose_stream() << "(optimize:sat)\n";);
         TRACE("opt", model_smt2_pp(tout, m, *m_model, 0););
         m_optsmt.setup(*m_opt_solver.get());
-        update_lower();
-        
+
+        if (!m_incremental) {
+            update_lower();
+            return adjust_unknown(execute_objectives());
+        }
+        // Pareto enumeration keeps its blocking constraints in the solver between calls.
+        if (m_objectives.size() > 1 && opt_params(m_params).priority() == symbol("pareto")) {
+            m_reuse_solver = false;
+            update_lower();
+            return adjust_unknown(execute_objectives());
+        }
+        // Retract what the engines assert, so that the next call starts from
+        // the hard constraints and the lemmas learned on them.
+        m_reuse_solver = false;
+        {
+            solver::scoped_push _push(s);
+            update_lower();
+            is_sat = execute_objectives();
+        }
+        m_reuse_solver = true;
+        m_last_model = m_model;
+        return adjust_unknown(is_sat);
+    }
+
+    lbool context::execute_objectives() {
+        lbool is_sat = l_true;
         switch (m_objectives.size()) {
         case 0:
             break;
         case 1:
-            is_sat = execute(m_objectives[0], true, false);
+            if (m_anytime_sls) {
+                is_sat = execute_anytime(m_objectives[0]);
+            }
+            else {
+                is_sat = execute(m_objectives[0], true, false);
+            }
             break;
         default: {
             opt_params optp(m_params);
@@ -277,7 +330,85 @@ namespace opt {
             break;
         }
         }
-        return adjust_unknown(is_sat);
+        return is_sat;
+    }
+
+    /**
+       \brief Initial satisfiability check of an incremental call: first assume 
+       the soft constraints that the previous result satisfied, so that the 
+       engines start from an upper bound close to the previous optimum.
+       The solvers only take literals as assumptions, so each soft constraint t
+       is assumed through a fresh literal b, with b => t asserted once.
+    */
+    lbool context::check_warm(solver& s) {
+        expr_ref_vector asms(m);
+        expr_ref val(m);
+        for (unsigned i = 0; m_last_model && i < m_objectives.size(); ++i) {
+            objective const& obj = m_objectives[i];
+            if (obj.m_type != O_MAXSMT) continue;
+            for (unsigned j = 0; j < obj.m_terms.size(); ++j) {
+                expr* t = obj.m_terms[j];
+                if (!m_last_model->eval(t, val) || !m.is_true(val)) {
+                    continue;
+                }
+                app* b = 0;
+                if (!m_warm_lits.find(t, b)) {
+                    b = m.mk_fresh_const("warm", m.mk_bool_sort());
+                    m_fm.insert(b->get_decl());
+                    m_warm_trail.push_back(t);
+                    m_warm_trail.push_back(b);
+                    m_warm_lits.insert(t, b);
+                    s.assert_expr(m.mk_implies(b, t));
+                }
+                asms.push_back(b);
+            }
+        }
+        if (!asms.empty()) {
+            IF_VERBOSE(1, verbose_stream() << "(optimize:warm-start " << asms.size() << ")\n";);
+            lbool is_sat = s.check_sat(asms.size(), asms.c_ptr());
+            if (is_sat == l_true || m.canceled()) {
+                return is_sat;
+            }
+        }
+        return s.check_sat(0, 0);
+    }
+
+    /**
+       \brief The solver of the previous call can be used if every hard constraint
+       it holds is still asserted, other than definitions of purified terms, and
+       the SAT core is still able to handle the constraints.
+    */
+    bool context::can_reuse_solver() {
+        if (!m_solver || !m_opt_solver) {
+            return false;
+        }
+        if (m_solver.get() == m_sat_solver.get() && !probe_bv()) {
+            return false;
+        }
+        obj_hashtable<expr> hard;
+        for (unsigned i = 0; i < m_hard_constraints.size(); ++i) {
+            hard.insert(m_hard_constraints[i].get());
+        }
+        expr* q, *t;
+        app* r;
+        for (unsigned i = 0; i < m_solver_hard.size(); ++i) {
+            expr* f = m_solver_hard[i].get();
+            if (hard.contains(f)) continue;
+            if (m.is_eq(f, q, t) && m_purified.find(t, r) && r == q) continue;
+            return false;
+        }
+        return true;
+    }
+
+    void context::assert_hard_constraints(solver& s) {
+        for (unsigned i = 0; i < m_hard_constraints.size(); ++i) {
+            expr* f = m_hard_constraints[i].get();
+            if (!m_solver_hard_set.contains(f)) {
+                m_solver_hard_set.insert(f);
+                m_solver_hard.push_back(f);
+                s.assert_expr(f);
+            }
+        }
     }
 
     lbool context::adjust_unknown(lbool r) {
@@ -332,6 +463,259 @@ namespace opt {
         return result;
     }
 
+    /**
+       \brief Local search for a MaxSAT objective, run in its own manager.
+       The best assignment is kept as the values of the Boolean constants
+       m_decls, so that the main thread can read it without touching m.
+    */
+    struct context::sls_worker {
+        ast_manager      m;
+        smt::pb_sls      m_sls;
+        expr_ref_vector  m_hard;
+        expr_ref_vector  m_soft;
+        vector<rational> m_weights;
+        func_decl_ref_vector m_decls;
+        svector<bool>    m_best;        // values of m_decls in the best model
+        rational         m_best_cost;
+        bool             m_improved;    // m_best was not read since it improved
+
+        sls_worker(ast_manager& m0): m(m0, true), m_sls(m), m_hard(m), m_soft(m), m_decls(m), m_improved(false) {}
+
+        struct collect_decls {
+            obj_hashtable<func_decl>& m_seen;
+            func_decl_ref_vector&     m_decls;
+            collect_decls(obj_hashtable<func_decl>& seen, func_decl_ref_vector& decls): m_seen(seen), m_decls(decls) {}
+            ast_manager& m() { return m_decls.get_manager(); }
+            void operator()(var*) {}
+            void operator()(quantifier*) {}
+            void operator()(app* a) {
+                if (is_uninterp_const(a) && m().is_bool(a) && !m_seen.contains(a->get_decl())) {
+                    m_seen.insert(a->get_decl());
+                    m_decls.push_back(a->get_decl());
+                }
+            }
+        };
+
+        void init(expr_ref_vector const& hard, objective const& obj, model* mdl, func_decl_ref_vector& decls) {
+            ast_translation tr(decls.get_manager(), m);
+            obj_hashtable<func_decl> seen;
+            collect_decls proc(seen, decls);
+            expr_fast_mark1 visited;
+            for (unsigned i = 0; i < hard.size(); ++i) {
+                quick_for_each_expr(proc, visited, hard[i]);
+                m_hard.push_back(tr(hard[i]));
+                m_sls.add(m_hard.back());
+            }
+            for (unsigned i = 0; i < obj.m_terms.size(); ++i) {
+                quick_for_each_expr(proc, visited, obj.m_terms[i]);
+                m_soft.push_back(tr(obj.m_terms[i]));
+                m_weights.push_back(obj.m_weights[i]);
+                m_sls.add(m_soft.back(), m_weights.back());
+            }
+            for (unsigned i = 0; i < decls.size(); ++i) {
+                m_decls.push_back(tr(decls[i].get()));
+            }
+            model_ref md = mdl->translate(tr);
+            m_sls.set_model(md);
+            evaluate(md.get(), m_best_cost);
+            get_values(md.get(), m_best);
+        }
+
+        // cost of mdl if it satisfies the hard constraints.
+        bool evaluate(model* mdl, rational& cost) {
+            expr_ref val(m);
+            for (unsigned i = 0; i < m_hard.size(); ++i) {
+                if (!mdl->eval(m_hard[i].get(), val, true) || !m.is_true(val)) {
+                    return false;
+                }
+            }
+            cost.reset();
+            for (unsigned i = 0; i < m_soft.size(); ++i) {
+                if (!mdl->eval(m_soft[i].get(), val, true) || !m.is_true(val)) {
+                    cost += m_weights[i];
+                }
+            }
+            return true;
+        }
+
+        void get_values(model* mdl, svector<bool>& values) {
+            expr_ref val(m);
+            values.reset();
+            for (unsigned i = 0; i < m_decls.size(); ++i) {
+                values.push_back(mdl->eval(m.mk_const(m_decls[i].get()), val, true) && m.is_true(val));
+            }
+        }
+
+        void run() {
+            model_ref mdl;
+            svector<bool> values;
+            rational cost;
+            while (!m.canceled() && !m_best_cost.is_zero()) {
+                if (m_sls() == l_undef) {
+                    break;
+                }
+                m_sls.get_model(mdl);
+                if (evaluate(mdl.get(), cost) && cost < m_best_cost) {
+                    get_values(mdl.get(), values);
+                    #pragma omp critical (opt_anytime)
+                    {
+                        m_best.reset();
+                        m_best.append(values);
+                        m_best_cost = cost;
+                        m_improved = true;
+                    }
+                    IF_VERBOSE(1, verbose_stream() << "(opt.sls improved cost: " << cost << ")\n";);
+                }
+                else if (mdl) {
+                    // restart the search from the best model.
+                    for (unsigned i = 0; i < m_decls.size(); ++i) {
+                        mdl->register_decl(m_decls[i].get(), m_best[i] ? m.mk_true() : m.mk_false());
+                    }
+                }
+                m_sls.set_model(mdl);
+            }
+        }
+    };
+
+    /**
+       \brief Solve a MaxSAT objective while local search improves the best model
+       in a helper thread. The engine is complete; the helper only provides better
+       models earlier, which are reported when the engine reports a model and when
+       it stops without an optimum.
+    */
+    lbool context::execute_anytime(objective const& obj) {
+#ifdef _NO_OMP_
+        return execute(obj, true, false);
+#else
+        if (obj.m_type != O_MAXSMT || omp_in_parallel() || !m_model) {
+            return execute(obj, true, false);
+        }
+        sls_worker w(m);
+        m_sls_decls.reset();
+        w.init(m_hard_constraints, obj, m_model.get(), m_sls_decls);
+        m_sls = &w;
+        m_sls_cost = w.m_best_cost;
+        m.limit().push_child(&w.m.limit());
+        lbool is_sat = l_undef;
+        bool has_exception = false;
+        std::string msg;
+        #pragma omp parallel sections num_threads(2)
+        {
+            #pragma omp section
+            {
+                try {
+                    is_sat = execute(obj, true, false);
+                }
+                catch (z3_exception& ex) {
+                    has_exception = true;
+                    msg = ex.msg();
+                }
+                w.m.limit().cancel();
+            }
+            #pragma omp section
+            {
+                try {
+                    w.run();
+                }
+                catch (z3_exception&) {
+                    // canceled.
+                }
+            }
+        }
+        m.limit().pop_child();
+        model_ref mdl;
+        rational cost;
+        if (is_sat != l_true && get_sls_model(mdl, cost)) {
+            m_model = mdl;
+            model_updated(mdl.get());
+        }
+        m_sls = 0;
+        m_sls_decls.reset();
+        if (has_exception) {
+            throw default_exception(msg.c_str());
+        }
+        return is_sat;
+#endif
+    }
+
+    /**
+       \brief Retrieve the best model of the local search if it improved since the
+       last call and still satisfies the hard constraints together with m_model.
+    */
+    bool context::get_sls_model(model_ref& mdl, rational& cost) {
+        if (!m_sls || !m_model) {
+            return false;
+        }
+        svector<bool> values;
+        #pragma omp critical (opt_anytime)
+        {
+            if (m_sls->m_improved) {
+                values.append(m_sls->m_best);
+                m_sls->m_improved = false;
+            }
+        }
+        if (values.empty()) {
+            return false;
+        }
+        mdl = m_model->copy();
+        // the worker translated m_sls_decls in the same order.
+        SASSERT(m_sls_decls.size() == values.size());
+        for (unsigned i = 0; i < m_sls_decls.size() && i < values.size(); ++i) {
+            mdl->register_decl(m_sls_decls[i].get(), values[i] ? m.mk_true() : m.mk_false());
+        }
+        objective const& obj = m_objectives[0];
+        expr_ref val(m);
+        for (unsigned i = 0; i < m_hard_constraints.size(); ++i) {
+            if (!mdl->eval(m_hard_constraints[i].get(), val, true) || !m.is_true(val)) {
+                return false;
+            }
+        }
+        return get_cost(obj, mdl.get(), cost) && cost < m_sls_cost;
+    }
+
+    bool context::get_cost(objective const& obj, model* mdl, rational& cost) {
+        if (obj.m_type != O_MAXSMT) {
+            return false;
+        }
+        expr_ref val(m);
+        cost.reset();
+        for (unsigned i = 0; i < obj.m_terms.size(); ++i) {
+            if (!mdl->eval(obj.m_terms[i], val, true) || !m.is_true(val)) {
+                cost += obj.m_weights[i];
+            }
+        }
+        return true;
+    }
+
+    /**
+       \brief Called by the engines with every model that improves the objective.
+       In anytime mode a better model of the local search is reported first.
+    */
+    void context::model_updated(model* md) {
+        rational cost;
+        if (m_sls && !m_objectives.empty() && get_cost(m_objectives[0], md, cost)) {
+            model_ref sls_mdl;
+            rational sls_cost;
+            if (get_sls_model(sls_mdl, sls_cost) && sls_cost < cost) {
+                m_sls_cost = sls_cost;
+                if (m_on_model) {
+                    fix_model(sls_mdl);
+                    m_on_model->on_model(sls_mdl);
+                }
+            }
+            if (cost >= m_sls_cost) {
+                return;
+            }
+            m_sls_cost = cost;
+        }
+        if (!m_on_model || !md) {
+            return;
+        }
+        model_ref mdl = md->copy();
+        fix_model(mdl);
+        m_on_model->on_model(mdl);
+    }
+
     lbool context::execute(objective const& obj, bool committed, bool scoped) {
         switch(obj.m_type) {
         case O_MAXIMIZE: return execute_min_max(obj.m_index, committed, scoped, true);
@@ -481,6 +865,31 @@ namespace opt {
         return result;
     }
 
+    void context::get_objective_term(unsigned i, expr_ref& term, bool& is_max) {
+        objective const& obj = m_objectives[i];
+        switch (obj.m_type) {
+        case O_MAXIMIZE:
+            term = obj.m_term;
+            is_max = true;
+            break;
+        case O_MINIMIZE:
+            term = obj.m_term;
+            is_max = false;
+            break;
+        case O_MAXSMT: {
+            // sum of the weights of the satisfied soft constraints.
+            expr_ref_vector sum(m);
+            expr_ref zero(m_arith.mk_numeral(rational(0), false), m);
+            for (unsigned j = 0; j < obj.m_terms.size(); ++j) {
+                sum.push_back(m.mk_ite(obj.m_terms[j], m_arith.mk_numeral(obj.m_weights[j], false), zero));
+            }
+            term = sum.empty() ? zero.get() : m_arith.mk_add(sum.size(), sum.c_ptr());
+            is_max = true;
+            break;
+        }
+        }
+    }
+
     void context::yield() {
         m_pareto->get_model(m_model, m_labels);
         update_bound(true);
@@ -489,7 +898,13 @@ namespace opt {
 
     lbool context::execute_pareto() {        
         if (!m_pareto) {
-            set_pareto(alloc(gia_pareto, m, *this, m_solver.get(), m_params));
+            unsigned num_threads = opt_params(m_params).pareto_threads();
+            if (num_threads > 1) {
+                set_pareto(alloc(par_pareto, m, *this, m_solver.get(), m_params, num_threads));
+            }
+            else {
+                set_pareto(alloc(gia_pareto, m, *this, m_solver.get(), m_params));
+            }
         }
         lbool is_sat = (*(m_pareto.get()))();
         if (is_sat != l_true) {
@@ -526,6 +941,13 @@ namespace opt {
     }
 
     void context::init_solver() {
+        m_reuse_solver = false;
+        m_solver_hard.reset();
+        m_solver_hard_set.reset();
+        m_warm_lits.reset();
+        m_warm_trail.reset();
+        m_sat_solver = 0;
+        m_last_model = 0;
         setup_arith_solver();
         m_opt_solver = alloc(opt_solver, m, m_params, m_fm);
         m_opt_solver->set_logic(m_logic);
@@ -681,28 +1103,35 @@ namespace opt {
         for (unsigned i = 0; i < fmls.size(); ++i) {
             g->assert_expr(fmls[i].get());
         }
-        tactic_ref tac0 = 
-            and_then(mk_simplify_tactic(m, m_params), 
-                     mk_propagate_values_tactic(m),
-                     mk_solve_eqs_tactic(m),
-                     // NB: mk_elim_uncstr_tactic(m) is not sound with soft constraints
-                     mk_simplify_tactic(m));   
         opt_params optp(m_params);
-        tactic_ref tac2, tac3, tac4;
-        if (optp.elim_01()) {
-            tac2 = mk_elim01_tactic(m);
-            tac3 = mk_lia2card_tactic(m);
-            tac4 = mk_eq2bv_tactic(m);
-            params_ref lia_p;
-            lia_p.set_bool("compile_equality", optp.pb_compile_equality());
-            tac3->updt_params(lia_p);
-            set_simplify(and_then(tac0.get(), tac2.get(), tac3.get(), tac4.get(), mk_simplify_tactic(m)));
+        if (m_incremental) {
+            // rewrite each formula in isolation, so that a hard constraint that is
+            // already in the solver is simplified to the same formula again.
+            set_simplify(mk_simplify_tactic(m, m_params));
         }
         else {
-            tactic_ref tac1 = 
-                and_then(tac0.get(),
-                         mk_simplify_tactic(m));            
-            set_simplify(tac1.get());
+            tactic_ref tac0 = 
+                and_then(mk_simplify_tactic(m, m_params), 
+                         mk_propagate_values_tactic(m),
+                         mk_solve_eqs_tactic(m),
+                         // NB: mk_elim_uncstr_tactic(m) is not sound with soft constraints
+                         mk_simplify_tactic(m));   
+            tactic_ref tac2, tac3, tac4;
+            if (optp.elim_01()) {
+                tac2 = mk_elim01_tactic(m);
+                tac3 = mk_lia2card_tactic(m);
+                tac4 = mk_eq2bv_tactic(m);
+                params_ref lia_p;
+                lia_p.set_bool("compile_equality", optp.pb_compile_equality());
+                tac3->updt_params(lia_p);
+                set_simplify(and_then(tac0.get(), tac2.get(), tac3.get(), tac4.get(), mk_simplify_tactic(m)));
+            }
+            else {
+                tactic_ref tac1 = 
+                    and_then(tac0.get(),
+                             mk_simplify_tactic(m));            
+                set_simplify(tac1.get());
+            }
         }
         proof_converter_ref pc;
         expr_dependency_ref core(m);
@@ -1006,9 +1435,18 @@ namespace opt {
     }
 
     app* context::purify(filter_model_converter_ref& fm, expr* term) {
-       std::ostringstream out;
-       out << mk_pp(term, m);
-       app* q = m.mk_fresh_const(out.str().c_str(), m.get_sort(term));
+       app* q = 0;
+       if (!m_incremental || !m_purified.find(term, q)) {
+           std::ostringstream out;
+           out << mk_pp(term, m);
+           q = m.mk_fresh_const(out.str().c_str(), m.get_sort(term));
+           if (m_incremental) {
+               // reuse the constant and its definition in later calls.
+               m_purified.insert(term, q);
+               m_purified_trail.push_back(term);
+               m_purified_trail.push_back(q);
+           }
+       }
        if (!fm) fm = alloc(filter_model_converter, m);
        m_hard_constraints.push_back(m.mk_eq(q, term));
        fm->insert(q->get_decl());                
@@ -1327,6 +1765,8 @@ namespace opt {
         opt_params _p(p);
         m_enable_sat = _p.enable_sat();
         m_enable_sls = _p.enable_sls();
+        m_anytime_sls = _p.anytime_sls();
+        m_incremental = _p.incremental();
         m_maxsat_engine = _p.maxsat_engine();
         m_pp_neat = _p.pp_neat();
     }
@@ -57,6 +57,18 @@ namespace opt {
         virtual unsigned num_objectives() = 0;
         virtual bool verify_model(unsigned id, model* mdl, rational const& v) = 0;
         virtual void set_model(model_ref& _m) = 0;
+        virtual void model_updated(model* mdl) = 0;      // notify that mdl improves the current objective.
+    };
+
+    /**
+       \brief Receives the models that improve the objectives while optimization
+       is in progress. Models are in terms of the original formulas, as with
+       get_model. The callback is invoked on the thread that called optimize().
+    */
+    class on_model_callback {
+    public:
+        virtual ~on_model_callback() {}
+        virtual void on_model(model_ref& mdl) = 0;
     };
 
     /**
@@ -167,6 +179,21 @@ namespace opt {
         symbol                       m_logic;
         svector<symbol>              m_labels;
         std::string                  m_unknown;
+        on_model_callback*           m_on_model;
+        bool                         m_anytime_sls;
+        struct sls_worker;
+        sls_worker*                  m_sls;        // local search running next to the engine, if any.
+        func_decl_ref_vector         m_sls_decls;  // Boolean constants whose values m_sls reports.
+        rational                     m_sls_cost;   // cost of the best model reported in anytime mode.
+        bool                         m_incremental;
+        bool                         m_reuse_solver;     // solver only holds constraints that may still be asserted.
+        expr_ref_vector              m_solver_hard;      // hard constraints asserted to the solver.
+        obj_hashtable<expr>          m_solver_hard_set;
+        obj_map<expr, app*>          m_purified;         // term -> fresh constant, shared across calls in incremental mode.
+        expr_ref_vector              m_purified_trail;
+        model_ref                    m_last_model;       // result of the previous call, used as a warm start.
+        obj_map<expr, app*>          m_warm_lits;        // soft constraint -> literal that implies it in the solver.
+        expr_ref_vector              m_warm_trail;
     public:
         context(ast_manager& m);
         virtual ~context();
@@ -196,6 +223,7 @@ namespace opt {
         virtual bool is_pareto() { return m_pareto.get() != 0; }
         virtual void set_logic(symbol const& s) { m_logic = s; }
         void set_clausal(bool f) { m_is_clausal = f; }
+        void set_on_model(on_model_callback* cb) { m_on_model = cb; }
 
         void display(std::ostream& out);
         static void collect_param_descrs(param_descrs & r);
@@ -212,6 +240,7 @@ namespace opt {
         virtual expr_ref mk_gt(unsigned i, model_ref& model);
         virtual expr_ref mk_ge(unsigned i, model_ref& model);
         virtual expr_ref mk_le(unsigned i, model_ref& model);
+        virtual void get_objective_term(unsigned i, expr_ref& term, bool& is_max);
 
         virtual smt::context& smt_context() { return m_opt_solver->get_context(); }
         virtual filter_model_converter& fm() { return m_fm; }
@@ -226,6 +255,8 @@ namespace opt {
 
         virtual bool verify_model(unsigned id, model* mdl, rational const& v);
 
+        virtual void model_updated(model* mdl);
+
     private:
         lbool execute(objective const& obj, bool committed, bool scoped);
         lbool execute_min_max(unsigned index, bool committed, bool scoped, bool is_max);
@@ -233,6 +264,13 @@ namespace opt {
         lbool execute_lex();
         lbool execute_box();
         lbool execute_pareto();
+        lbool execute_anytime(objective const& obj);
+        lbool execute_objectives();
+        lbool check_warm(solver& s);
+        bool  can_reuse_solver();
+        void  assert_hard_constraints(solver& s);
+        bool  get_sls_model(model_ref& mdl, rational& cost);
+        bool  get_cost(objective const& obj, model* mdl, rational& cost);
         lbool adjust_unknown(lbool r);
         bool scoped_lex();
         expr_ref to_expr(inf_eps const& n);
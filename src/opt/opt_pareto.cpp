@@ -21,6 +21,10 @@ Notes:
 #include "opt_pareto.h"
 #include "ast_pp.h"
 #include "model_smt2_pp.h"
+#include "ast_translation.h"
+#include "arith_decl_plugin.h"
+#include "bv_decl_plugin.h"
+#include "smt_solver.h"
 
 namespace opt {
 
@@ -103,5 +107,237 @@ namespace opt {
         return is_sat;
     }
 
-}
+    // ---------------------------------
+    // Parallel enumeration over boxes
+
+    struct par_pareto::worker {
+        ast_manager      m;
+        ref<solver>      m_solver;
+        expr_ref_vector  m_terms;       // objective terms.
+        svector<bool>    m_is_max;
+        arith_util       m_arith;
+        bv_util          m_bv;
+        expr_ref         m_box;         // region to explore in this round.
+        model_ref        m_model;       // Pareto optimal point found from the box.
+        vector<rational> m_values;      // its objective values.
+        lbool            m_result;
+
+        worker(ast_manager& m0, solver& s, expr_ref_vector const& terms, svector<bool> const& is_max, params_ref const& p):
+            m(m0, true), m_terms(m), m_arith(m), m_bv(m), m_box(m), m_result(l_undef) {
+            ast_translation tr(m0, m);
+            m_solver = mk_smt_solver(m, p, symbol::null);
+            for (unsigned i = 0; i < s.get_num_assertions(); ++i) {
+                m_solver->assert_expr(tr(s.get_assertion(i)));
+            }
+            for (unsigned i = 0; i < terms.size(); ++i) {
+                m_terms.push_back(tr(terms[i]));
+            }
+            m_is_max.append(is_max);
+        }
+
+        bool get_values(model* mdl, vector<rational>& values) {
+            expr_ref val(m);
+            rational r;
+            unsigned sz;
+            values.reset();
+            for (unsigned i = 0; i < m_terms.size(); ++i) {
+                if (!mdl->eval(m_terms[i].get(), val, true) || 
+                    !(m_arith.is_numeral(val, r) || m_bv.is_numeral(val, r, sz))) {
+                    return false;
+                }
+                values.push_back(r);
+            }
+            return true;
+        }
+
+        // objective i is better than v, or at least as good as v.
+        expr_ref mk_better(unsigned i, rational const& v, bool strict) {
+            expr* t = m_terms[i].get();
+            expr_ref val(m), r(m);
+            if (m_bv.is_bv(t)) {
+                val = m_bv.mk_numeral(v, m_bv.get_bv_size(t));
+                if (m_is_max[i]) {
+                    r = strict ? m.mk_not(m_bv.mk_ule(t, val)) : m_bv.mk_ule(val, t);
+                }
+                else {
+                    r = strict ? m.mk_not(m_bv.mk_ule(val, t)) : m_bv.mk_ule(t, val);
+                }
+            }
+            else {
+                val = m_arith.mk_numeral(v, m_arith.is_int(t));
+                if (m_is_max[i]) {
+                    r = strict ? m_arith.mk_gt(t, val) : m_arith.mk_ge(t, val);
+                }
+                else {
+                    r = strict ? m_arith.mk_lt(t, val) : m_arith.mk_le(t, val);
+                }
+            }
+            return r;
+        }
+
+        /**
+           \brief Find a model in the box, then improve it against the whole
+           problem until no model dominates it.
+        */
+        void run() {
+            m_model = 0;
+            m_result = l_undef;
+            {
+                solver::scoped_push _s(*m_solver.get());
+                m_solver->assert_expr(m_box);
+                lbool is_sat = m_solver->check_sat(0, 0);
+                if (is_sat != l_true) {
+                    m_result = is_sat;
+                    return;
+                }
+                m_solver->get_model(m_model);
+            }
+            solver::scoped_push _s(*m_solver.get());
+            while (true) {
+                if (!get_values(m_model.get(), m_values)) {
+                    return;
+                }
+                expr_ref_vector ge(m), gt(m);
+                for (unsigned i = 0; i < m_terms.size(); ++i) {
+                    ge.push_back(mk_better(i, m_values[i], false));
+                    gt.push_back(mk_better(i, m_values[i], true));
+                }
+                ge.push_back(m.mk_or(gt.size(), gt.c_ptr()));
+                m_solver->assert_expr(m.mk_and(ge.size(), ge.c_ptr()));
+                lbool is_sat = m_solver->check_sat(0, 0);
+                if (is_sat == l_undef) {
+                    return;
+                }
+                if (is_sat == l_false) {
+                    break;
+                }
+                m_solver->get_model(m_model);
+            }
+            m_result = l_true;
+        }
+    };
+
+    par_pareto::par_pareto(ast_manager & m, pareto_callback& cb, solver* s, params_ref & p, unsigned num_threads):
+        pareto_base(m, cb, s, p),
+        m_num_threads(std::max(1u, num_threads)),
+        m_boxes(m),
+        m_init(false) {
+    }
 
+    par_pareto::~par_pareto() {}
+
+    void par_pareto::init() {
+        expr_ref_vector terms(m);
+        svector<bool> is_max;
+        expr_ref t(m);
+        for (unsigned i = 0; i < cb.num_objectives(); ++i) {
+            bool mx = true;
+            cb.get_objective_term(i, t, mx);
+            terms.push_back(t);
+            is_max.push_back(mx);
+        }
+        for (unsigned i = 0; i < m_num_threads; ++i) {
+            m_workers.push_back(alloc(worker, m, *m_solver.get(), terms, is_max, m_params));
+        }
+        m_boxes.push_back(m.mk_true());
+        m_init = true;
+    }
+
+    bool par_pareto::is_new(vector<rational> const& values) const {
+        for (unsigned i = 0; i < m_values.size(); ++i) {
+            vector<rational> const& v = m_values[i];
+            bool eq = v.size() == values.size();
+            for (unsigned j = 0; eq && j < v.size(); ++j) {
+                eq = v[j] == values[j];
+            }
+            if (eq) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    lbool par_pareto::operator()() {
+        if (!m_init) {
+            init();
+        }
+        while (m_front.empty() && !m_boxes.empty()) {
+            lbool is_sat = explore();
+            if (is_sat != l_true) {
+                return is_sat;
+            }
+        }
+        if (m_front.empty()) {
+            return l_false;
+        }
+        m_model = m_front.back();
+        m_front.pop_back();
+        m_labels.reset();
+        return l_true;
+    }
+
+    /**
+       \brief Explore one box per worker. Every point p found splits its box B
+       into the parts of B that p does not dominate:
+       B & gt_i(p) & le_0(p) & ... & le_{i-1}(p) for each objective i.
+    */
+    lbool par_pareto::explore() {
+        unsigned n = std::min(m_boxes.size(), m_workers.size());
+        expr_ref_vector boxes(m);
+        for (unsigned j = 0; j < n; ++j) {
+            worker& w = *m_workers[j];
+            ast_translation tr(m, w.m);
+            boxes.push_back(m_boxes.back());
+            w.m_box = tr(m_boxes.back());
+            m_boxes.pop_back();
+            m.limit().push_child(&w.m.limit());
+        }
+        IF_VERBOSE(1, verbose_stream() << "(opt.pareto boxes: " << n << " pending: " << m_boxes.size() 
+                   << " points: " << m_values.size() << ")\n";);
+        #pragma omp parallel for num_threads(n)
+        for (int j = 0; j < static_cast<int>(n); ++j) {
+            worker& w = *m_workers[j];
+            try {
+                w.run();
+            }
+            catch (z3_exception& ex) {
+                IF_VERBOSE(1, verbose_stream() << "(opt.pareto " << ex.msg() << ")\n";);
+                w.m_result = l_undef;
+            }
+        }
+        for (unsigned j = 0; j < n; ++j) {
+            m.limit().pop_child();
+        }
+        unsigned sz = cb.num_objectives();
+        for (unsigned j = 0; j < n; ++j) {
+            worker& w = *m_workers[j];
+            if (w.m_result == l_undef) {
+                m_boxes.append(boxes.size() - j, boxes.c_ptr() + j);
+                return l_undef;
+            }
+            if (w.m_result == l_false) {
+                continue;
+            }
+            ast_translation tr(w.m, m);
+            model_ref mdl = w.m_model->translate(tr);
+            if (is_new(w.m_values)) {
+                m_values.push_back(w.m_values);
+                m_front.push_back(mdl.get());
+            }
+            // the worker solvers do not handle the pseudo-Boolean bounds of cb.mk_gt
+            // for MaxSMT objectives, so the boxes compare the objective terms.
+            expr_ref_vector box(m);
+            box.push_back(boxes[j].get());
+            for (unsigned i = 0; i < sz; ++i) {
+                expr_ref gt(w.mk_better(i, w.m_values[i], true), w.m);
+                expr_ref le(w.m.mk_not(gt), w.m);
+                expr_ref_vector conj(box);
+                conj.push_back(tr(gt.get()));
+                m_boxes.push_back(m.mk_and(conj.size(), conj.c_ptr()));
+                box.push_back(tr(le.get()));
+            }
+        }
+        return l_true;
+    }
+
+}
@@ -22,6 +22,7 @@ Notes:
 
 #include "solver.h"
 #include "model.h"
+#include "scoped_ptr_vector.h"
 
 namespace opt {
    
@@ -32,6 +33,8 @@ namespace opt {
         virtual expr_ref mk_ge(unsigned i, model_ref& model) = 0;
         virtual expr_ref mk_le(unsigned i, model_ref& model) = 0;
         virtual void fix_model(model_ref& m) = 0;
+        // numeric term of objective i; larger values are better if is_max holds.
+        virtual void get_objective_term(unsigned i, expr_ref& term, bool& is_max) = 0;
     };
     class pareto_base {
     protected:
@@ -105,6 +108,36 @@ namespace opt {
 
         virtual lbool operator()();
     };
+
+    /**
+       \brief Enumerate the front with several solvers, each in its own manager.
+       The region that no known point dominates is split into disjoint boxes,
+       which are explored concurrently. A point found in a box is improved
+       against the whole problem, so every point returned is Pareto optimal;
+       points with the same objective values are returned once.
+    */
+    class par_pareto : public pareto_base {
+        struct worker;
+        unsigned                  m_num_threads;
+        scoped_ptr_vector<worker> m_workers;
+        expr_ref_vector           m_boxes;     // regions left to explore.
+        sref_vector<model>        m_front;     // points found, not returned yet.
+        vector<vector<rational> > m_values;    // objective values of the points found.
+        bool                      m_init;
+
+        void init();
+        lbool explore();
+        bool is_new(vector<rational> const& values) const;
+    public:
+        par_pareto(ast_manager & m, 
+                   pareto_callback& cb, 
+                   solver* s, 
+                   params_ref & p,
+                   unsigned num_threads);
+        virtual ~par_pareto();
+
+        virtual lbool operator()();
+    };
 }
 
 #endif
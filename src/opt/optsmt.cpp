@@ -30,6 +30,7 @@ Notes:
 
 #include <typeinfo>
 #include "optsmt.h"
+#include "opt_context.h"
 #include "opt_solver.h"
 #include "arith_decl_plugin.h"
 #include "theory_arith.h"
@@ -154,6 +155,7 @@ namespace opt {
                     m_s->maximize_objectives(disj);
                     m_s->get_model(m_model);       
                     m_s->get_labels(m_labels);            
+                    m_context.model_updated(m_model.get());
                     for (unsigned i = 0; i < ors.size(); ++i) {
                         expr_ref tmp(m);
                         if (m_model->eval(ors[i].get(), tmp) && m.is_true(tmp)) {
@@ -216,6 +218,7 @@ namespace opt {
                    verbose_stream() << ")\n";);
         IF_VERBOSE(3, verbose_stream() << disj << "\n";);
         IF_VERBOSE(3, model_pp(verbose_stream(), *m_model););
+        m_context.model_updated(m_model.get());
 
         return expr_ref(m.mk_or(disj.size(), disj.c_ptr()), m);
     }
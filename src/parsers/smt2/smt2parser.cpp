@@ -2480,6 +2480,23 @@ namespace smt2 {
             }
         }
         
+        class scoped_cmd_latency {
+            cmd_context & m_ctx;
+            symbol        m_cmd;
+            stopwatch     m_watch;
+        public:
+            scoped_cmd_latency(cmd_context & ctx, symbol const & cmd):m_ctx(ctx), m_cmd(cmd) {
+                if (m_ctx.cmd_latency_stats()) 
+                    m_watch.start();
+            }
+            ~scoped_cmd_latency() {
+                if (m_ctx.cmd_latency_stats()) {
+                    m_watch.stop();
+                    m_ctx.record_cmd_latency(m_cmd, m_watch.get_seconds());
+                }
+            }
+        };
+
         void parse_cmd() {
             SASSERT(curr_is_lparen());
             int line = m_scanner.get_line();
@@ -2487,6 +2504,7 @@ namespace smt2 {
             next();
             check_identifier("invalid command, symbol expected");
             symbol s = curr_id();
+            scoped_cmd_latency _latency(m_ctx, s);
             if (s == m_assert) {
                 parse_assert();
                 return;
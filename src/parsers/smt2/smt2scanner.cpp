@@ -239,6 +239,7 @@ namespace smt2 {
 
     scanner::scanner(cmd_context & ctx, std::istream& stream, bool interactive):
         m_interactive(interactive),
+        m_pending_next(false),
         m_spos(0),
         m_curr(0), // avoid Valgrind warning
         m_line(1),
@@ -289,6 +290,11 @@ namespace smt2 {
     }
 
     scanner::token scanner::scan() {
+        if (m_pending_next) {
+            m_pending_next = false;
+            m_curr = m_stream.get();
+            m_spos++;
+        }
         while (true) {
             signed char c = curr();
             m_pos = m_spos;
@@ -310,7 +316,16 @@ namespace smt2 {
                 next();
                 return LEFT_PAREN;
             case ')':
-                next();
+                if (m_interactive) {
+                    // Do not block on the input stream: the command closed by this
+                    // parenthesis must be executed before more input is available.
+                    if (m_cache_input)
+                        m_cache.push_back(m_curr);
+                    m_pending_next = true;
+                }
+                else {
+                    next();
+                }
                 return RIGHT_PAREN;
             case '|':
                 return read_quoted_symbol();
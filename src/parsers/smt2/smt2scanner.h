@@ -32,6 +32,7 @@ namespace smt2 {
     class scanner {
     private:
         bool               m_interactive;
+        bool               m_pending_next; // interactive mode: the character after ')' was not read yet
         int                m_spos; // position in the current line of the stream
         char               m_curr;  // current char;
         
@@ -0,0 +1,299 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_maxsat.cpp
+
+Abstract:
+
+    Core-guided weighted MaxSAT with incremental totalizers.
+
+Notes:
+
+--*/
+
+#include "sat_maxsat.h"
+
+namespace sat {
+
+    maxsat::maxsat(solver& s): s(s), m_lower(0), m_upper(0), m_model_is_current(false), m_exhaust(true) {}
+
+    maxsat::~maxsat() {}
+
+    void maxsat::reset() {
+        m_soft.reset();
+        m_weights.reset();
+        m_asms.reset();
+        m_lit2asm.reset();
+        m_nodes.reset();
+        m_best_model.reset();
+        m_lower = 0;
+        m_upper = 0;
+        m_model_is_current = false;
+    }
+
+    void maxsat::collect_statistics(statistics& st) const {
+        st.update("sat maxsat cores", m_stats.m_num_cores);
+        st.update("sat maxsat totalizers", m_stats.m_num_totalizers);
+        st.update("sat maxsat extensions", m_stats.m_num_extensions);
+        st.update("sat maxsat exhausted", m_stats.m_num_exhausted);
+        st.update("sat maxsat hardened", m_stats.m_num_hardened);
+    }
+
+    lbool maxsat::operator()(unsigned sz, literal const* soft, uint64 const* weights) {
+        reset();
+        uint64 stratum = 0;
+        for (unsigned i = 0; i < sz; ++i) {
+            m_soft.push_back(soft[i]);
+            m_weights.push_back(weights[i]);
+            m_upper += weights[i];
+            add_soft(soft[i], weights[i], UINT_MAX, 0);
+            stratum = std::max(stratum, m_asms[m_lit2asm.find(soft[i].index())].m_weight);
+        }
+        literal_vector asms;
+        while (m_lower < m_upper) {
+            get_stratum(stratum, asms);
+            lbool is_sat = check(asms.size(), asms.c_ptr());
+            if (is_sat == l_undef) {
+                return l_undef;
+            }
+            if (is_sat == l_true) {
+                update_upper();
+                stratum = next_stratum(stratum);
+                if (stratum == 0) {
+                    // every assumption holds, so the lower bound is attained.
+                    SASSERT(m_lower == m_upper);
+                    m_lower = m_upper;
+                }
+                continue;
+            }
+            literal_vector core;
+            for (unsigned i = 0; i < s.get_core().size(); ++i) {
+                if (m_lit2asm.contains(s.get_core()[i].index())) {
+                    core.push_back(s.get_core()[i]);
+                }
+            }
+            if (core.empty()) {
+                return l_false;
+            }
+            is_sat = process_core(core);
+            if (is_sat != l_true) {
+                return is_sat;
+            }
+        }
+        if (!m_model_is_current) {
+            // replay the best assignment so that it is the model of the solver.
+            asms.reset();
+            for (unsigned i = 0; i < m_soft.size() && !m_best_model.empty(); ++i) {
+                if (value_at(m_soft[i], m_best_model) == l_true) {
+                    asms.push_back(m_soft[i]);
+                }
+            }
+            lbool is_sat = check(asms.size(), asms.c_ptr());
+            if (is_sat != l_true) {
+                return is_sat;
+            }
+            update_upper();
+        }
+        return l_true;
+    }
+
+    lbool maxsat::check(unsigned sz, literal const* asms) {
+        m_model_is_current = false;
+        return s.check(sz, asms);
+    }
+
+    void maxsat::add_soft(literal l, uint64 w, unsigned tot, unsigned bound) {
+        unsigned idx;
+        if (m_lit2asm.find(l.index(), idx)) {
+            // a repeated soft literal, or a totalizer output that is relaxed again.
+            m_asms[idx].m_weight += w;
+            return;
+        }
+        m_lit2asm.insert(l.index(), m_asms.size());
+        m_asms.push_back(soft(l, w, tot, bound));
+    }
+
+    void maxsat::get_stratum(uint64 min_weight, literal_vector& asms) const {
+        asms.reset();
+        for (unsigned i = 0; i < m_asms.size(); ++i) {
+            if (m_asms[i].m_weight > 0 && m_asms[i].m_weight >= min_weight) {
+                asms.push_back(m_asms[i].m_lit);
+            }
+        }
+    }
+
+    uint64 maxsat::next_stratum(uint64 min_weight) const {
+        uint64 result = 0;
+        for (unsigned i = 0; i < m_asms.size(); ++i) {
+            uint64 w = m_asms[i].m_weight;
+            if (w < min_weight && w > result) {
+                result = w;
+            }
+        }
+        return result;
+    }
+
+    void maxsat::update_upper() {
+        model const& mdl = s.get_model();
+        uint64 cost = 0;
+        for (unsigned i = 0; i < m_soft.size(); ++i) {
+            if (value_at(m_soft[i], mdl) != l_true) {
+                cost += m_weights[i];
+            }
+        }
+        if (cost < m_upper || m_best_model.empty()) {
+            m_upper = cost;
+            m_best_model.reset();
+            m_best_model.append(mdl);
+            m_model_is_current = true;
+            IF_VERBOSE(2, verbose_stream() << "(sat.maxsat [" << m_lower << ":" << m_upper << "])\n";);
+        }
+    }
+
+    /**
+       \brief Charge the least weight w of the core to the lower bound, raise the
+       bounds of the totalizer outputs in the core, and relax the core.
+    */
+    lbool maxsat::process_core(literal_vector const& core) {
+        ++m_stats.m_num_cores;
+        uint64 w = 0;
+        for (unsigned i = 0; i < core.size(); ++i) {
+            uint64 wi = m_asms[m_lit2asm.find(core[i].index())].m_weight;
+            if (i == 0 || wi < w) {
+                w = wi;
+            }
+        }
+        m_lower += w;
+        IF_VERBOSE(2, verbose_stream() << "(sat.maxsat [" << m_lower << ":" << m_upper << "] core: " << core.size() << ")\n";);
+        for (unsigned i = 0; i < core.size(); ++i) {
+            soft& a = m_asms[m_lit2asm.find(core[i].index())];
+            a.m_weight -= w;
+            unsigned n = a.m_tot, bound = a.m_bound + 1;
+            if (n != UINT_MAX && bound < m_nodes[n].m_size) {
+                extend(n, bound + 1);
+                add_soft(~m_nodes[n].m_out[bound], w, n, bound);
+                ++m_stats.m_num_extensions;
+            }
+        }
+        if (core.size() == 1) {
+            // the hard clauses imply the negation of the assumption.
+            literal lit = ~core[0];
+            s.pop_to_base_level();
+            s.mk_clause(1, &lit);
+            ++m_stats.m_num_hardened;
+            return l_true;
+        }
+        return relax(core, w);
+    }
+
+    /**
+       \brief Add a totalizer over the negated core literals, of which at least one
+       is false, and assume that at most one of them is false.
+    */
+    lbool maxsat::relax(literal_vector const& core, uint64 w) {
+        literal_vector lits;
+        for (unsigned i = 0; i < core.size(); ++i) {
+            lits.push_back(~core[i]);
+        }
+        s.pop_to_base_level();
+        unsigned n = mk_totalizer(lits, 0, lits.size());
+        ++m_stats.m_num_totalizers;
+        unsigned bound = 1;
+        extend(n, bound + 1);
+        if (m_exhaust) {
+            lbool is_sat = exhaust(n, bound, w);
+            if (is_sat != l_true) {
+                return is_sat;
+            }
+        }
+        if (bound < m_nodes[n].m_size) {
+            add_soft(~m_nodes[n].m_out[bound], w, n, bound);
+        }
+        return l_true;
+    }
+
+    /**
+       \brief Raise the bound of the totalizer rooted at n while the hard clauses
+       refute it, charging w to the lower bound for each step.
+    */
+    lbool maxsat::exhaust(unsigned n, unsigned& bound, uint64 w) {
+        while (bound < m_nodes[n].m_size && m_lower < m_upper) {
+            literal lit = ~m_nodes[n].m_out[bound];
+            lbool is_sat = check(1, &lit);
+            if (is_sat == l_true) {
+                update_upper();
+                return l_true;
+            }
+            if (is_sat == l_undef) {
+                return l_undef;
+            }
+            if (!s.get_core().contains(lit)) {
+                // the hard clauses are unsatisfiable.
+                return l_false;
+            }
+            m_lower += w;
+            ++bound;
+            ++m_stats.m_num_exhausted;
+            lit.neg();
+            s.pop_to_base_level();
+            s.mk_clause(1, &lit);
+            if (bound < m_nodes[n].m_size) {
+                extend(n, bound + 1);
+            }
+        }
+        return l_true;
+    }
+
+    unsigned maxsat::mk_totalizer(literal_vector const& lits, unsigned lo, unsigned hi) {
+        SASSERT(lo < hi);
+        node nd;
+        nd.m_size = hi - lo;
+        nd.m_left = nd.m_right = UINT_MAX;
+        if (nd.m_size == 1) {
+            nd.m_out.push_back(lits[lo]);
+        }
+        else {
+            unsigned mid = lo + nd.m_size / 2;
+            nd.m_left = mk_totalizer(lits, lo, mid);
+            nd.m_right = mk_totalizer(lits, mid, hi);
+        }
+        m_nodes.push_back(nd);
+        return m_nodes.size() - 1;
+    }
+
+    /**
+       \brief Create the outputs of node n up to the given bound, with the clauses
+       L[i] & R[j] => out[i + j + 1] (an index of -1 standing for true).
+    */
+    void maxsat::extend(unsigned n, unsigned bound) {
+        bound = std::min(bound, m_nodes[n].m_size);
+        if (m_nodes[n].m_out.size() >= bound) {
+            return;
+        }
+        unsigned l = m_nodes[n].m_left, r = m_nodes[n].m_right;
+        extend(l, bound);
+        extend(r, bound);
+        literal_vector const& L = m_nodes[l].m_out;
+        literal_vector const& R = m_nodes[r].m_out;
+        literal_vector& out = m_nodes[n].m_out;
+        literal_vector lits;
+        for (unsigned j = out.size() + 1; j <= bound; ++j) {
+            literal o(s.mk_var(true, true), false);
+            out.push_back(o);
+            for (unsigned i = 0; i <= j; ++i) {
+                unsigned k = j - i;
+                if (i > L.size() || k > R.size()) {
+                    continue;
+                }
+                lits.reset();
+                if (i > 0) lits.push_back(~L[i - 1]);
+                if (k > 0) lits.push_back(~R[k - 1]);
+                lits.push_back(o);
+                s.mk_clause(lits);
+            }
+        }
+    }
+
+};
@@ -0,0 +1,118 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_maxsat.h
+
+Abstract:
+
+    Core-guided weighted MaxSAT over the literals of the SAT solver.
+
+    The algorithm follows OLL: every core with more than one literal is
+    relaxed by a totalizer over the negations of its literals, and the
+    totalizer output "at most k of them are false" becomes a new soft
+    literal. When such an output occurs in a later core, the totalizer is
+    extended to the next bound instead of being encoded again.
+    Soft literals are assumed in decreasing strata of weights, and the
+    bound of a new totalizer is raised for as long as the hard clauses
+    alone refute it (core exhaustion). Cores are minimized by the SAT
+    solver itself when sat.minimize_core is set.
+
+Notes:
+
+--*/
+#ifndef SAT_MAXSAT_H_
+#define SAT_MAXSAT_H_
+
+#include "sat_solver.h"
+#include "statistics.h"
+#include "map.h"
+
+namespace sat {
+
+    class maxsat {
+        struct stats {
+            unsigned m_num_cores;
+            unsigned m_num_totalizers;
+            unsigned m_num_extensions;
+            unsigned m_num_exhausted;
+            unsigned m_num_hardened;
+            stats() { reset(); }
+            void reset() { memset(this, 0, sizeof(*this)); }
+        };
+
+        /**
+           \brief Node of a totalizer: m_out[j] holds when at least j+1 of the
+           leaves below the node hold. Leaves have no children and m_out[0] is
+           the input literal.
+        */
+        struct node {
+            unsigned       m_left, m_right;
+            unsigned       m_size;
+            literal_vector m_out;
+        };
+
+        /**
+           \brief Assumption with weight m_weight. If m_tot is not UINT_MAX the
+           literal is the negation of output m_bound of the totalizer rooted at
+           node m_tot, that is, at most m_bound of its leaves hold.
+        */
+        struct soft {
+            literal  m_lit;
+            uint64   m_weight;
+            unsigned m_tot;
+            unsigned m_bound;
+            soft(literal l, uint64 w, unsigned t, unsigned b): m_lit(l), m_weight(w), m_tot(t), m_bound(b) {}
+        };
+
+        solver&        s;
+        literal_vector m_soft;            // original soft literals
+        svector<uint64> m_weights;        // their weights
+        svector<soft>  m_asms;            // current assumptions
+        u_map<unsigned> m_lit2asm;        // literal index -> position in m_asms
+        vector<node>   m_nodes;
+        uint64         m_lower;
+        uint64         m_upper;
+        model          m_best_model;
+        bool           m_model_is_current;
+        bool           m_exhaust;
+        stats          m_stats;
+
+    public:
+        maxsat(solver& s);
+        ~maxsat();
+
+        /**
+           \brief Find an assignment that satisfies the clauses of the solver and
+           minimizes the sum of the weights of the false soft literals.
+           Return l_false if the clauses are unsatisfiable and l_undef if the
+           search was interrupted; the bounds remain valid in either case.
+           On l_true the model of the solver is an optimal assignment.
+        */
+        lbool operator()(unsigned sz, literal const* soft, uint64 const* weights);
+
+        uint64 get_lower() const { return m_lower; }
+        uint64 get_upper() const { return m_upper; }
+        model const& get_model() const { return m_best_model; }
+        void set_exhaust(bool f) { m_exhaust = f; }
+        void collect_statistics(statistics& st) const;
+
+    private:
+        void reset();
+        void add_soft(literal l, uint64 w, unsigned tot, unsigned bound);
+        void get_stratum(uint64 min_weight, literal_vector& asms) const;
+        uint64 next_stratum(uint64 min_weight) const;
+        lbool check(unsigned sz, literal const* asms);
+        void update_upper();
+        lbool process_core(literal_vector const& core);
+        lbool relax(literal_vector const& core, uint64 w);
+        lbool exhaust(unsigned n, unsigned& bound, uint64 w);
+
+        unsigned mk_totalizer(literal_vector const& lits, unsigned lo, unsigned hi);
+        void extend(unsigned n, unsigned bound);
+    };
+
+};
+
+#endif
@@ -20,6 +20,7 @@ Notes:
 #include "solver.h"
 #include "tactical.h"
 #include "sat_solver.h"
+#include "sat_maxsat.h"
 #include "tactic2solver.h"
 #include "aig_tactic.h"
 #include "propagate_values_tactic.h"
@@ -156,6 +157,37 @@ public:
         }
         return r;
     }
+    /**
+       \brief Minimize the weight of the false soft constraints with sat::maxsat.
+       Return l_undef without searching if a soft constraint has no literal.
+    */
+    lbool maxsat(unsigned sz, expr * const * soft, uint64 const* weights, bool exhaust_cores, 
+                 uint64& lower, uint64& upper, statistics& st) {
+        m_weights.reset();
+        m_model = 0;
+        dep2asm_t dep2asm;
+        m_solver.pop_to_base_level();
+        lbool r = internalize_formulas();
+        if (r != l_true) return r;
+        r = internalize_assumptions(sz, soft, dep2asm);
+        if (r != l_true) return r;
+        sat::literal_vector lits;
+        for (unsigned i = 0; i < sz; ++i) {
+            sat::literal lit;
+            if (!dep2asm.find(soft[i], lit)) {
+                return l_undef;
+            }
+            lits.push_back(lit);
+        }
+        sat::maxsat ms(m_solver);
+        ms.set_exhaust(exhaust_cores);
+        r = ms(sz, lits.c_ptr(), weights);
+        lower = ms.get_lower();
+        upper = ms.get_upper();
+        ms.collect_statistics(st);
+        return r;
+    }
+
     virtual void push() {
         internalize_formulas();
         m_solver.user_push();
@@ -468,6 +500,25 @@ lbool inc_sat_check_sat(solver& _s, unsigned sz, expr*const* soft, rational cons
     return s.check_sat(sz, soft, weights.c_ptr(), max_weight.get_double());
 }
 
+lbool inc_sat_maxsat(solver& _s, unsigned sz, expr*const* soft, rational const* _weights, bool exhaust_cores, 
+                     rational& lower, rational& upper, statistics& st) {
+    inc_sat_solver& s = dynamic_cast<inc_sat_solver&>(_s);
+    svector<uint64> weights;
+    rational sum(0);
+    for (unsigned i = 0; i < sz; ++i) {
+        sum += _weights[i];
+        if (!_weights[i].is_uint64() || !sum.is_uint64()) {
+            return l_undef;
+        }
+        weights.push_back(_weights[i].get_uint64());
+    }
+    uint64 lo = 0, hi = 0;
+    lbool r = s.maxsat(sz, soft, weights.c_ptr(), exhaust_cores, lo, hi, st);
+    lower = rational(lo, rational::ui64());
+    upper = rational(hi, rational::ui64());
+    return r;
+}
+
 void inc_sat_display(std::ostream& out, solver& _s, unsigned sz, expr*const* soft, rational const* _weights) {
     inc_sat_solver& s = dynamic_cast<inc_sat_solver&>(_s);
     vector<unsigned> weights;
@@ -26,6 +26,8 @@ solver* mk_inc_sat_solver(ast_manager& m, params_ref const& p);
 
 lbool inc_sat_check_sat(solver& s, unsigned sz, expr*const* soft, rational const* weights, rational const& max_weight);
 
+lbool inc_sat_maxsat(solver& s, unsigned sz, expr*const* soft, rational const* weights, bool exhaust_cores, rational& lower, rational& upper, statistics& st);
+
 void  inc_sat_display(std::ostream& out, solver& s, unsigned sz, expr*const* soft, rational const* _weights);
 
 #endif
@@ -41,6 +41,7 @@ typedef enum { IN_UNSPECIFIED, IN_SMTLIB, IN_SMTLIB_2, IN_DATALOG, IN_DIMACS, IN
 std::string         g_aux_input_file;
 char const *        g_input_file          = 0;
 bool                g_standard_input      = false;
+bool                g_streaming           = false;
 input_kind          g_input_kind          = IN_UNSPECIFIED;
 bool                g_display_statistics  = false;
 bool                g_display_istatistics = false;
@@ -75,6 +76,8 @@ void display_usage() {
     std::cout << "  -dimacs     use parser for DIMACS input format.\n";
     std::cout << "  -log        use parser for Z3 log input format.\n";
     std::cout << "  -in         read formula from standard input.\n";
+    std::cout << "  -stream     read SMT 2 commands from standard input, answer each command as soon as it is complete,\n";
+    std::cout << "              always use the incremental solver, and report per-command latencies with -st.\n";
     std::cout << "\nMiscellaneous:\n";
     std::cout << "  -h, -?      prints this message.\n";
     std::cout << "  -version    prints version number of Z3.\n";
@@ -169,6 +172,13 @@ void parse_cmd_line_args(int argc, char ** argv) {
             else if (strcmp(opt_name, "in") == 0) {
                 g_standard_input = true;
             }
+            else if (strcmp(opt_name, "stream") == 0) {
+                g_standard_input = true;
+                g_streaming      = true;
+                g_input_kind     = IN_SMTLIB_2;
+                // never fall back to the non-incremental solver between queries.
+                gparams::set("combined_solver.ignore_solver1", "true");
+            }
             else if (strcmp(opt_name, "dimacs") == 0) {
                 g_input_kind = IN_DIMACS;
             }
@@ -339,7 +349,7 @@ int STD_CALL main(int argc, char ** argv) {
             break;
         case IN_SMTLIB_2:
             memory::exit_when_out_of_memory(true, "(error \"out of memory\")");
-            return_value = read_smtlib2_commands(g_input_file);
+            return_value = read_smtlib2_commands(g_input_file, g_streaming);
             break;
         case IN_DIMACS:
             return_value = read_dimacs(g_input_file);
@@ -99,7 +99,7 @@ unsigned read_smtlib_file(char const * benchmark_file) {
     return solver.get_error_code();
 }
 
-unsigned read_smtlib2_commands(char const * file_name) {
+unsigned read_smtlib2_commands(char const * file_name, bool streaming) {
     g_start_time = clock();
     register_on_timeout_proc(on_timeout);
     signal(SIGINT, on_ctrl_c);
@@ -114,6 +114,12 @@ unsigned read_smtlib2_commands(char const * file_name) {
     install_subpaving_cmds(ctx);
     install_opt_cmds(ctx);
 
+    if (streaming) {
+        // results are reported as soon as a command is closed, and 
+        // the per-command latencies are part of the statistics.
+        ctx.set_cmd_latency_stats(true);
+    }
+
     g_cmd_context = &ctx;
     signal(SIGINT, on_ctrl_c);
 
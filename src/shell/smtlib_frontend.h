@@ -20,7 +20,7 @@ Revision History:
 #define SMTLIB_FRONTEND_H_
 
 unsigned read_smtlib_file(char const * benchmark_file);
-unsigned read_smtlib2_commands(char const * command_file);
+unsigned read_smtlib2_commands(char const * command_file, bool streaming = false);
 
 #endif /* SMTLIB_FRONTEND_H_ */
 
@@ -101,7 +101,7 @@ namespace smt {
 
     literal context::translate_literal(
         literal lit, context& src_ctx, context& dst_ctx,
-        vector<bool_var> b2v, ast_translation& tr) {
+        vector<bool_var>& b2v, ast_translation& tr) {
         ast_manager& dst_m = dst_ctx.get_manager();
         ast_manager& src_m = src_ctx.get_manager();
         expr_ref dst_f(dst_m);
@@ -174,46 +174,46 @@ namespace smt {
             lit = TRANSLATE(src_ctx.m_assigned_literals[i]);
             dst_ctx.mk_clause(1, &lit, 0, CLS_AUX, 0);
         }
-#if 0
+        if (dst_ctx.m_fparams.m_copy_lemmas && !src_m.proofs_enabled()) {
+            copy_lemmas(src_ctx, dst_ctx, b2v, tr);
+        }
+        
+        TRACE("smt_context", 
+              src_ctx.display(tout);
+              dst_ctx.display(tout););
+    }
+
+
+    void context::copy_lemmas(context& src_ctx, context& dst_ctx, vector<bool_var>& b2v, ast_translation& tr) {
+        // Learned clauses and theory lemmas are consequences of the asserted formulas 
+        // and the theory axioms, so they can be replayed in the destination context.
+        // Binary lemmas are stored in the watch lists together with auxiliary clauses 
+        // and are not copied.
         literal_vector lits;
-        expr_ref_vector cls(src_m);
         for (unsigned i = 0; i < src_ctx.m_lemmas.size(); ++i) {
-            lits.reset();
-            cls.reset();
             clause& src_cls = *src_ctx.m_lemmas[i];
             unsigned sz = src_cls.get_num_literals();
-            for (unsigned j = 0; j < sz; ++j) {
-                literal lit = TRANSLATE(src_cls.get_literal(j));
-                lits.push_back(lit);
+            bool is_true = false;
+            lits.reset();
+            for (unsigned j = 0; !is_true && j < sz; ++j) {
+                literal lit = src_cls.get_literal(j);
+                if (lit == true_literal) {
+                    is_true = true;
+                }
+                else if (lit != false_literal) {
+                    lits.push_back(translate_literal(lit, src_ctx, dst_ctx, b2v, tr));
+                }
             }
-            dst_ctx.mk_clause(lits.size(), lits.c_ptr(), 0, src_cls.get_kind(), 0);
-        }        
-        vector<watch_list>::const_iterator it  = src_ctx.m_watches.begin();
-        vector<watch_list>::const_iterator end = src_ctx.m_watches.end();
-        literal ls[2];
-        for (unsigned l_idx = 0; it != end; ++it, ++l_idx) {
-            literal l1 = to_literal(l_idx);
-            literal neg_l1 = ~l1;
-            watch_list const & wl = *it;
-            literal const * it2  = wl.begin_literals();
-            literal const * end2 = wl.end_literals();
-            for (; it2 != end2; ++it2) {
-                literal l2 = *it2;
-                if (l1.index() < l2.index()) {
-                    ls[0] = TRANSLATE(neg_l1);
-                    ls[1] = TRANSLATE(l2);
-                    dst_ctx.mk_clause(2, ls, 0, CLS_AUX, 0);
-                }                
+            if (!is_true) {
+                dst_ctx.mk_clause(lits.size(), lits.c_ptr(), 0, CLS_AUX_LEMMA, 0);
+                dst_ctx.m_stats.m_num_copied_lemmas++;
+            }
+            if (dst_ctx.inconsistent()) {
+                break;
             }
         }
-#endif
-        
-        TRACE("smt_context", 
-              src_ctx.display(tout);
-              dst_ctx.display(tout););
     }
 
-
     context::~context() {
         flush();
     }
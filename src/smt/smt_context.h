@@ -1341,7 +1341,9 @@ namespace smt {
 
         static literal translate_literal(
             literal lit, context& src_ctx, context& dst_ctx,
-            vector<bool_var> b2v, ast_translation& tr);
+            vector<bool_var>& b2v, ast_translation& tr);
+
+        static void copy_lemmas(context& src_ctx, context& dst_ctx, vector<bool_var>& b2v, ast_translation& tr);
 
 
     public:
@@ -387,6 +387,7 @@ namespace smt {
         st.update("minimized lits", m_stats.m_num_minimized_lits);
         st.update("num checks", m_stats.m_num_checks);
         st.update("mk bool var", m_stats.m_num_mk_bool_var);
+        st.update("copied lemmas", m_stats.m_num_copied_lemmas);
 
 #if 0
         // missing?
@@ -385,6 +385,67 @@ static void tst_eval_sign() {
 
 }
 
+static bool same_sign(int s1, int s2) {
+    return (s1 == 0) == (s2 == 0) && (s1 < 0) == (s2 < 0);
+}
+
+static void tst_eval_sign_fp() {
+    // compare signs obtained using floating point intervals with the precise ones.
+    reslimit rl;
+    unsynch_mpq_manager        qm;
+    polynomial::manager        pm(rl, qm);
+    params_ref                 ps;
+    ps.set_bool("fp_filter", false);
+    algebraic_numbers::manager am(rl, qm);
+    algebraic_numbers::manager am_exact(rl, qm, ps);
+    polynomial_ref x0(pm);
+    polynomial_ref x1(pm);
+    x0 = pm.mk_polynomial(pm.mk_var());
+    x1 = pm.mk_polynomial(pm.mk_var());
+    polynomial_ref p(pm);
+    scoped_anum v0(am), v1(am), w0(am_exact), w1(am_exact);
+    scoped_mpq q(qm);
+    int64 big = 1ll << 40;
+    for (int i = -6; i <= 6; i++) {
+        for (int j = -4; j <= 4; j++) {
+            qm.set(q, i * big + j, static_cast<uint64>(3));
+            am.set(v0, q);
+            am_exact.set(w0, q);
+            qm.set(q, j, 7);
+            am.set(v1, q);
+            am_exact.set(w1, q);
+            p = (x0^2) - 3*x0*x1 - (x1^3) + 1;
+            polynomial::simple_var2value<anum_manager> x2v(am), x2w(am_exact);
+            x2v.push_back(0, v0); x2v.push_back(1, v1);
+            x2w.push_back(0, w0); x2w.push_back(1, w1);
+            SASSERT(same_sign(am.eval_sign_at(p, x2v), am_exact.eval_sign_at(p, x2w)));
+            p = 7*x1 - j;
+            SASSERT(same_sign(am.eval_sign_at(p, x2v), am_exact.eval_sign_at(p, x2w)));
+            SASSERT(am.eval_sign_at(p, x2v) == 0);
+            p = 3*x0 - rational(i * big + j, rational::i64());
+            SASSERT(am.eval_sign_at(p, x2v) == 0);
+        }
+    }
+    am.set(v0, 2);
+    am.root(v0, 2, v0);
+    am_exact.set(w0, 2);
+    am_exact.root(w0, 2, w0);
+    am.set(v1, 1);
+    am_exact.set(w1, 1);
+    polynomial::simple_var2value<anum_manager> x2v(am), x2w(am_exact);
+    x2v.push_back(0, v0); x2v.push_back(1, v1);
+    x2w.push_back(0, w0); x2w.push_back(1, w1);
+    p = (x0^2) - 2*x1;
+    SASSERT(am.eval_sign_at(p, x2v) == 0);
+    p = x0 - x1;
+    SASSERT(same_sign(am.eval_sign_at(p, x2v), am_exact.eval_sign_at(p, x2w)));
+    p = 1000*x0 - 1414*x1;
+    SASSERT(same_sign(am.eval_sign_at(p, x2v), am_exact.eval_sign_at(p, x2w)));
+    statistics st;
+    am.collect_statistics(st);
+    st.display(std::cout);
+}
+
 static void tst_isolate_roots(polynomial_ref const & p, anum_manager & am,
                               polynomial::var x0, anum const & v0, polynomial::var x1, anum const & v1, polynomial::var x2, anum const & v2) {
     polynomial::simple_var2value<anum_manager> x2v(am);
@@ -573,6 +634,7 @@ void tst_algebraic() {
     tst_isolate_roots();
     ex1();
     tst_eval_sign();
+    tst_eval_sign_fp();
     tst_select_small();
     tst_dejan();
     tst_wilkinson();
@@ -0,0 +1,54 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+--*/
+
+#include<sstream>
+#include"z3.h"
+#include"debug.h"
+
+static Z3_lbool bmc_query(char const* spec, unsigned num_threads) {
+    Z3_config cfg = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context(cfg);
+    Z3_del_config(cfg);
+    Z3_fixedpoint fp = Z3_mk_fixedpoint(ctx);
+    Z3_fixedpoint_inc_ref(ctx, fp);
+    Z3_params p = Z3_mk_params(ctx);
+    Z3_params_inc_ref(ctx, p);
+    Z3_params_set_symbol(ctx, p, Z3_mk_string_symbol(ctx, "engine"), Z3_mk_string_symbol(ctx, "bmc"));
+    Z3_params_set_uint(ctx, p, Z3_mk_string_symbol(ctx, "bmc.threads"), num_threads);
+    Z3_fixedpoint_set_params(ctx, fp, p);
+    Z3_ast_vector queries = Z3_fixedpoint_from_string(ctx, fp, spec);
+    Z3_ast_vector_inc_ref(ctx, queries);
+    VERIFY(Z3_ast_vector_size(ctx, queries) == 1);
+    Z3_lbool r = Z3_fixedpoint_query(ctx, fp, Z3_ast_vector_get(ctx, queries, 0));
+    if (r == Z3_L_TRUE) {
+        VERIFY(Z3_fixedpoint_get_answer(ctx, fp) != 0);
+    }
+    Z3_ast_vector_dec_ref(ctx, queries);
+    Z3_params_dec_ref(ctx, p);
+    Z3_fixedpoint_dec_ref(ctx, fp);
+    Z3_del_context(ctx);
+    return r;
+}
+
+// counterexamples at one or two depths, found by one or several threads.
+static void tst_bmc_threads() {
+    for (unsigned depth = 0; depth < 8; ++depth) {
+        for (unsigned num_threads = 1; num_threads <= 3; ++num_threads) {
+            std::ostringstream strm;
+            strm << "(declare-rel inv (Int))\n"
+                 << "(declare-rel err ())\n"
+                 << "(declare-var x Int)\n"
+                 << "(rule (=> (= x 0) (inv x)))\n"
+                 << "(rule (=> (inv x) (inv (+ x 1))))\n"
+                 << "(rule (=> (and (inv x) (or (= x " << depth << ") (= x " << 2*depth + 5 << "))) err))\n"
+                 << "(query err)\n";
+            VERIFY(bmc_query(strm.str().c_str(), num_threads) == Z3_L_TRUE);
+        }
+    }
+}
+
+void tst_bmc() {
+    tst_bmc_threads();
+}
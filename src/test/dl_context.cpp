@@ -10,6 +10,7 @@ Copyright (c) 2015 Microsoft Corporation
 #include "dl_context.h"
 #include "smt_params.h"
 #include "dl_register_engine.h"
+#include "dl_relation_manager.h"
 
 using namespace datalog;
 
@@ -53,6 +54,159 @@ static void dl_context_simple_query_test(params_ref & params) {
 #endif
 }
 
+static void dl_context_incremental_query_test(bool use_magic_sets) {
+    ast_manager m;
+    dl_decl_util decl_util(m);
+    register_engine re;
+    smt_params fparams;
+    context ctx(m, re, fparams);
+    params_ref params;
+    params.set_sym("engine", symbol("datalog"));
+    params.set_bool("datalog.incremental", true);
+    params.set_bool("datalog.magic_sets_for_queries", use_magic_sets);
+    ctx.updt_params(params);
+
+    parser* p = parser::create(ctx, m);
+    TRUSTME( p->parse_string("Z 64\n\nP(x:Z)\nQ(x:Z)\nR(x:Z)\nQ(x) :- P(x).\nR(x) :- Q(x).\n") );
+    dealloc(p);
+    func_decl * P = ctx.try_get_predicate_decl(symbol("P"));
+    func_decl * Q = ctx.try_get_predicate_decl(symbol("Q"));
+    func_decl * R = ctx.try_get_predicate_decl(symbol("R"));
+    VERIFY(P && Q && R);
+    sort * s = P->get_domain(0);
+    app_ref query(m.mk_app(R, m.mk_var(0, s)), m);
+    relation_fact f(m);
+    f.push_back(decl_util.mk_numeral(1, s));
+
+    // all relations are empty when the rules are transformed.
+    VERIFY(ctx.query(query) == l_false);
+
+    // P was empty: the rules transformed for the first query must not be reused.
+    unsigned v = 1;
+    ctx.add_table_fact(P, 1, &v);
+    VERIFY(ctx.query(query) == l_true);
+    VERIFY(ctx.result_contains_fact(f));
+
+    // P already has facts: only the new fact is propagated.
+    v = 2;
+    ctx.add_table_fact(P, 1, &v);
+    VERIFY(ctx.query(query) == l_true);
+    f[0] = decl_util.mk_numeral(2, s);
+    VERIFY(ctx.result_contains_fact(f));
+
+    // facts for a predicate that is also defined by rules.
+    v = 5;
+    ctx.add_table_fact(Q, 1, &v);
+    VERIFY(ctx.query(query) == l_true);
+    f[0] = decl_util.mk_numeral(5, s);
+    VERIFY(ctx.result_contains_fact(f));
+    f[0] = decl_util.mk_numeral(3, s);
+    VERIFY(!ctx.result_contains_fact(f));
+}
+
+static void dl_context_incremental_replan_test() {
+    ast_manager m;
+    dl_decl_util decl_util(m);
+    register_engine re;
+    smt_params fparams;
+    context ctx(m, re, fparams);
+    params_ref params;
+    params.set_sym("engine", symbol("datalog"));
+    params.set_bool("datalog.incremental", true);
+    params.set_bool("datalog.profile_joins", true);
+    ctx.updt_params(params);
+
+    parser* p = parser::create(ctx, m);
+    TRUSTME( p->parse_string("Z 64\n\nE(x:Z, y:Z)\nT(x:Z, y:Z)\n"
+                             "T(x, y) :- E(x, y).\nT(x, z) :- T(x, y), E(y, z).\n") );
+    dealloc(p);
+    func_decl * E = ctx.try_get_predicate_decl(symbol("E"));
+    func_decl * T = ctx.try_get_predicate_decl(symbol("T"));
+    VERIFY(E && T);
+    sort * s = E->get_domain(0);
+    app_ref query(m.mk_app(T, m.mk_var(0, s), m.mk_var(1, s)), m);
+    relation_manager & rm = ctx.get_rel_context()->get_rmanager();
+    relation_fact f(m);
+    f.push_back(decl_util.mk_numeral(0, s));
+    f.push_back(decl_util.mk_numeral(0, s));
+
+    unsigned end = 0;
+    for (unsigned round = 0; round < 2; ++round) {
+        // the new edges need several iterations, and the joins are planned again in between.
+        for (unsigned i = 0; i < 10; ++i, ++end) {
+            unsigned row[2] = { end, end + 1 };
+            ctx.add_table_fact(E, 2, row);
+        }
+        VERIFY(ctx.query(query) == l_true);
+        f[1] = decl_util.mk_numeral(end, s);
+        VERIFY(rm.get_relation(T).contains_fact(f));
+    }
+}
+
+static void dl_context_cardinality_test() {
+    ast_manager m;
+    dl_decl_util decl_util(m);
+    register_engine re;
+    smt_params fparams;
+    context ctx(m, re, fparams);
+    params_ref params;
+    params.set_sym("engine", symbol("datalog"));
+    params.set_bool("datalog.profile_joins", true);
+    ctx.updt_params(params);
+
+    parser* p = parser::create(ctx, m);
+    TRUSTME( p->parse_string("Z 100000\n\nP(x:Z, y:Z)\nS(x:Z)\nE(x:Z, y:Z)\nT(x:Z, y:Z)\n"
+                             "S(x) :- P(x, y).\nT(x, y) :- E(x, y).\nT(x, z) :- T(x, y), E(y, z).\n") );
+    dealloc(p);
+    func_decl * P = ctx.try_get_predicate_decl(symbol("P"));
+    func_decl * E = ctx.try_get_predicate_decl(symbol("E"));
+    func_decl * T = ctx.try_get_predicate_decl(symbol("T"));
+    VERIFY(P && E && T);
+    sort * s = P->get_domain(0);
+
+    const unsigned num_rows = 30000;
+    for (unsigned i = 0; i < num_rows; ++i) {
+        unsigned row[2] = { i % 100, i };
+        ctx.add_table_fact(P, 2, row);
+    }
+    // a chain, so that the closure needs one loop iteration per edge.
+    const unsigned chain = 20;
+    for (unsigned i = 0; i + 1 < chain; ++i) {
+        unsigned row[2] = { i, i + 1 };
+        ctx.add_table_fact(E, 2, row);
+    }
+
+    // the joins are planned again between the iterations of the closure.
+    app_ref query(m.mk_app(T, m.mk_var(0, s), m.mk_var(1, s)), m);
+    VERIFY(ctx.query(query) == l_true);
+    relation_manager & rm = ctx.get_rel_context()->get_rmanager();
+    relation_fact f(m);
+    f.push_back(decl_util.mk_numeral(0, s));
+    f.push_back(decl_util.mk_numeral(chain - 1, s));
+    VERIFY(rm.get_relation(T).contains_fact(f));
+
+    relation_manager::cardinality const * c = rm.get_cardinality(P);
+    VERIFY(c && c->m_rows == num_rows && c->m_distinct.size() == 2);
+    // the sample is spread over the whole table.
+    VERIFY(c->m_distinct[0] == 100);
+    VERIFY(c->m_distinct[1] == num_rows);
+
+    // the cardinalities of P do not apply to a predicate P of another arity.
+    func_decl_ref P1(m.mk_func_decl(symbol("P"), 1, &s, m.mk_bool_sort()), m);
+    VERIFY(!rm.get_cardinality(P1));
+
+    std::stringstream strm;
+    rm.display_cardinalities(strm);
+    strm << "P 1 7\n";
+    VERIFY(rm.read_cardinalities(strm));
+    c = rm.get_cardinality(P1);
+    VERIFY(c && c->m_rows == 7 && c->m_distinct.empty());
+    c = rm.get_cardinality(P);
+    VERIFY(c && c->m_rows == num_rows && c->m_distinct[0] == 100);
+    std::istringstream bad("P 2 10 1 2 3\n");
+    VERIFY(!rm.read_cardinalities(bad));
+}
+
 void dl_context_saturate_file(params_ref & params, const char * f) {
     ast_manager m;
     dl_decl_util decl_util(m);
@@ -77,6 +231,10 @@ void tst_dl_context() {
     symbol relations[] = { symbol("tr_skip"), symbol("tr_sparse"), symbol("tr_hashtable"), symbol("smt_relation2")  };
     const unsigned rel_cnt = sizeof(relations)/sizeof(symbol);
 
+    dl_context_incremental_query_test(false);
+    dl_context_incremental_query_test(true);
+    dl_context_incremental_replan_test();
+    dl_context_cardinality_test();
     return;
 #if 0
     const char * test_file = "c:\\tvm\\src\\benchmarks\\datalog\\t0.datalog";
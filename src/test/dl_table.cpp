@@ -95,10 +95,206 @@ void test_dl_bitvector_table() {
     test_table(mk_bv_table);
 }
 
-void tst_dl_table() {
-    test_dl_bitvector_table();
+#endif
+
+#include "dl_context.h"
+#include "dl_trie_table.h"
+#include "dl_mapped_table.h"
+#include "dl_register_engine.h"
+#include "dl_relation_manager.h"
+
+static void add_pair(datalog::table_base & t, unsigned a, unsigned b) {
+    datalog::table_fact f;
+    f.push_back(a);
+    f.push_back(b);
+    t.add_fact(f);
+}
+
+static void test_dl_trie_table() {
+    smt_params params;
+    ast_manager ast_m;
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, params);    
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_plugin * p = m.get_table_plugin(symbol("trie"));
+    SASSERT(p);
+
+    datalog::table_signature sig;
+    sig.push_back(16);
+    sig.push_back(16);
+
+    // edges of the cycle 0 -> 1 -> ... -> 9 -> 0, added out of order and with duplicates.
+    datalog::table_base * e = p->mk_empty(sig);
+    for (unsigned i = 10; i-- > 0; ) {
+        add_pair(*e, i, (i + 1) % 10);
+        add_pair(*e, i, (i + 1) % 10);
+    }
+    SASSERT(e->get_size_estimate_rows() == 10);
+    datalog::table_fact f;
+    f.push_back(3);
+    f.push_back(4);
+    SASSERT(e->contains_fact(f));
+    f[1] = 5;
+    SASSERT(!e->contains_fact(f));
+
+    // paths of length two: join the target of the first edge with the source of the second.
+    unsigned cols1[1] = { 1 };
+    unsigned cols2[1] = { 0 };
+    datalog::table_join_fn * join = m.mk_join_fn(*e, *e, 1, cols1, cols2);
+    datalog::table_base * path2 = (*join)(*e, *e);
+    SASSERT(path2->get_size_estimate_rows() == 10);
+    datalog::table_base::iterator it = path2->begin(), end = path2->end();
+    for (; it != end; ++it) {
+        SASSERT(((*it)[0] + 1) % 10 == (*it)[1]);
+        SASSERT((*it)[1] == (*it)[2]);
+        SASSERT(((*it)[2] + 1) % 10 == (*it)[3]);
+    }
+
+    // union reports only the new rows in the delta.
+    datalog::table_base * src = p->mk_empty(sig);
+    datalog::table_base * delta = p->mk_empty(sig);
+    add_pair(*src, 3, 4);
+    add_pair(*src, 3, 5);
+    add_pair(*src, 12, 0);
+    datalog::table_union_fn * u = m.mk_union_fn(*e, *src, delta);
+    (*u)(*e, *src, delta);
+    SASSERT(e->get_size_estimate_rows() == 12);
+    SASSERT(delta->get_size_estimate_rows() == 2);
+    SASSERT(e->contains_fact(f));
+
+    // remove the edges whose source is the target of a delta row.
+    unsigned t_cols[1] = { 0 };
+    unsigned neg_cols[1] = { 1 };
+    datalog::table_intersection_filter_fn * neg = m.mk_filter_by_negation_fn(*e, *delta, 1, t_cols, neg_cols);
+    (*neg)(*e, *delta);
+    SASSERT(e->get_size_estimate_rows() == 10);
+    SASSERT(e->contains_fact(f));
+    f[0] = 0;
+    f[1] = 1;
+    SASSERT(!e->contains_fact(f));
+    f[0] = 5;
+    f[1] = 6;
+    SASSERT(!e->contains_fact(f));
+
+    dealloc(join);
+    dealloc(u);
+    dealloc(neg);
+    e->deallocate();
+    path2->deallocate();
+    src->deallocate();
+    delta->deallocate();
+}
+
+static void write_mapped_table_file(char const * file_name, unsigned n, const uint64 * col0, const uint64 * col1) {
+    uint64 header[4] = { 0x004c45524c44335aull, 2, n, n };
+    FILE * out = fopen(file_name, "wb");
+    VERIFY(out);
+    fwrite(header, sizeof(uint64), 4, out);
+    fwrite(col0, sizeof(uint64), n, out);
+    fwrite(col1, sizeof(uint64), n, out);
+    fclose(out);
 }
+
+static std::string mk_temp_file_name(char const * name) {
+#ifdef _WINDOWS
+    char const * dir = getenv("TEMP");
 #else
-void tst_dl_table() {
+    char const * dir = getenv("TMPDIR");
+    if (!dir) dir = "/tmp";
+#endif
+    std::string r(dir ? dir : ".");
+    r += "/";
+    r += name;
+    return r;
+}
+
+static void test_dl_mapped_table() {
+    smt_params params;
+    ast_manager ast_m;
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, params);    
+    params_ref ps;
+    // runs of 4 rows or more are stored in temporary files.
+    ps.set_uint("datalog.mapped_table_spill_rows", 4);
+    ctx.updt_params(ps);
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_plugin * p = m.get_table_plugin(symbol("mapped"));
+    VERIFY(p);
+
+    datalog::table_signature sig;
+    sig.push_back(16);
+    sig.push_back(16);
+
+    datalog::table_base * e = p->mk_empty(sig);
+    for (unsigned i = 10; i-- > 0; ) {
+        add_pair(*e, i, (i + 1) % 10);
+        add_pair(*e, i, (i + 1) % 10);
+    }
+    VERIFY(e->get_size_estimate_rows() == 10);
+    datalog::table_fact f;
+    f.push_back(3);
+    f.push_back(4);
+    VERIFY(e->contains_fact(f));
+
+    // union with a table of another kind reports only the new rows in the delta.
+    datalog::table_base * src = m.get_table_plugin(symbol("sparse"))->mk_empty(sig);
+    datalog::table_base * delta = p->mk_empty(sig);
+    add_pair(*src, 3, 4);
+    add_pair(*src, 3, 5);
+    add_pair(*src, 12, 0);
+    datalog::table_union_fn * u = m.mk_union_fn(*e, *src, delta);
+    (*u)(*e, *src, delta);
+    VERIFY(e->get_size_estimate_rows() == 12);
+    VERIFY(delta->get_size_estimate_rows() == 2);
+
+    e->remove_fact(f);
+    VERIFY(e->get_size_estimate_rows() == 11);
+    VERIFY(!e->contains_fact(f));
+    datalog::table_base * c = e->clone();
+    VERIFY(c->get_size_estimate_rows() == 11);
+    f[1] = 5;
+    VERIFY(c->contains_fact(f));
+
+    // a sorted file becomes the run of an empty table, an unsorted one is merged into it.
+    std::string sorted_file = mk_temp_file_name("z3_dl_mapped_table_sorted.bin");
+    std::string unsorted_file = mk_temp_file_name("z3_dl_mapped_table_unsorted.bin");
+    uint64 sorted0[3] = { 1, 1, 2 };
+    uint64 sorted1[3] = { 0, 7, 3 };
+    write_mapped_table_file(sorted_file.c_str(), 3, sorted0, sorted1);
+    datalog::table_base * l = p->mk_empty(sig);
+    datalog::mapped_table_plugin::get(*l).load(sorted_file.c_str());
+    VERIFY(l->get_size_estimate_rows() == 3);
+    // the table keeps its own copy of the rows.
+    uint64 other0[1] = { 5 };
+    uint64 other1[1] = { 5 };
+    write_mapped_table_file(sorted_file.c_str(), 1, other0, other1);
+    f[0] = 1;
+    f[1] = 7;
+    VERIFY(l->contains_fact(f));
+    uint64 unsorted0[4] = { 2, 15, 0, 2 };
+    uint64 unsorted1[4] = { 3, 15, 9, 3 };
+    write_mapped_table_file(unsorted_file.c_str(), 4, unsorted0, unsorted1);
+    datalog::mapped_table_plugin::get(*l).load(unsorted_file.c_str());
+    VERIFY(l->get_size_estimate_rows() == 5);
+    datalog::table_base::iterator it = l->begin(), end = l->end();
+    VERIFY((*it)[0] == 0 && (*it)[1] == 9);
+    ++it;
+    VERIFY((*it)[0] == 1 && (*it)[1] == 0);
+    remove(sorted_file.c_str());
+    remove(unsorted_file.c_str());
+
+    dealloc(u);
+    e->deallocate();
+    c->deallocate();
+    src->deallocate();
+    delta->deallocate();
+    l->deallocate();
 }
+
+void tst_dl_table() {
+#if defined(_WINDOWS) || defined(_CYGWIN)
+    test_dl_bitvector_table();
 #endif
+    test_dl_trie_table();
+    test_dl_mapped_table();
+}
@@ -476,7 +476,71 @@ public:
 };
 
 
+static doc* mk_rand_doc(doc_manager& m, random_gen& r) {
+    doc* d = m.allocateX();
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        // mostly fixed bits, with a few don't cares.
+        switch (r(8)) {
+        case 0: break;
+        case 1: case 2: case 3: m.set(*d, i, BIT_0); break;
+        default: m.set(*d, i, BIT_1); break;
+        }
+    }
+    return d;
+}
+
+static bool same_union(doc_manager& m, udoc& a, udoc& b) {
+    if (a.size() != b.size()) return false;
+    for (unsigned i = 0; i < a.size(); ++i) {
+        if (!b.contains(m, a[i]) || !a.contains(m, b[i])) return false;
+    }
+    return true;
+}
+
+// inserting and joining through an index gives the same unions as the plain loops.
+static void tst_doc_index(unsigned n) {
+    doc_manager m(n), m2(2*n);
+    random_gen r(n);
+    udoc a, b, c;
+    for (unsigned i = 0; i < 200; ++i) {
+        doc_ref d(m, mk_rand_doc(m, r));
+        a.insert(m, m.allocate(*d));
+        c.push_back(m.allocate(*d));
+    }
+    {
+        udoc::index idx(m, b);
+        for (unsigned i = 0; i < c.size(); ++i) {
+            idx.insert(m.allocate(c[i]));
+        }
+    }
+    VERIFY(same_union(m, a, b));
+
+    unsigned_vector cols1, cols2;
+    for (unsigned i = 0; i < n / 2; ++i) {
+        cols1.push_back(i);
+        cols2.push_back(n - 1 - i);
+    }
+    udoc j1, j2;
+    j1.join(c, c, m2, m, cols1, cols2);
+    for (unsigned i = 0; i < c.size(); ++i) {
+        for (unsigned k = 0; k < c.size(); ++k) {
+            if (doc* d = m2.join(c[i], c[k], m, cols1, cols2)) {
+                j2.insert(m2, d);
+            }
+        }
+    }
+    VERIFY(same_union(m2, j1, j2));
+    a.reset(m);
+    b.reset(m);
+    c.reset(m);
+    j1.reset(m2);
+    j2.reset(m2);
+}
+
 void tst_doc() {
+    tst_doc_index(6);
+    tst_doc_index(20);
+    tst_doc_index(70);
 
     test_doc_cls tp(4);
     tp.test_project1();
@@ -140,8 +140,10 @@ int main(int argc, char ** argv) {
     TST(ast);
     TST(optional);
     TST(bit_vector);
+    TST(obj_mark);
     TST(fixed_bit_vector);
     TST(tbv);
+    TST_ARGV(tbv_bench);
     TST(doc);
     TST(udoc_relation);
     TST(string_buffer);
@@ -165,6 +167,7 @@ int main(int argc, char ** argv) {
     TST(matcher);
     TST(object_allocator);
     TST(mpz);
+    TST_ARGV(mpz_bench);
     TST(mpq);
     TST(mpf);
     TST(total_order);
@@ -187,6 +190,8 @@ int main(int argc, char ** argv) {
     TST(theory_dl);
     TST(model_retrieval);
     TST(model_based_opt);
+    TST(maxres);
+    TST(opt_pareto);
     TST(factor_rewriter);
     TST(smt2print_parse);
     TST(substitution);
@@ -226,6 +231,7 @@ int main(int argc, char ** argv) {
     TST(simplex);
     TST(sat_user_scope);
     TST(pdr);
+    TST(bmc);
     TST_ARGV(ddnf);
     TST(model_evaluator);
     //TST_ARGV(hs);
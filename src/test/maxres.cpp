@@ -0,0 +1,191 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+--*/
+
+#include "opt_context.h"
+#include "reg_decl_plugins.h"
+#include "arith_decl_plugin.h"
+#include "util.h"
+
+struct maxsmt_instance {
+    ast_manager&      m;
+    expr_ref_vector   m_hard;
+    expr_ref_vector   m_soft;
+    vector<rational>  m_weights;
+    maxsmt_instance(ast_manager& m): m(m), m_hard(m), m_soft(m) {}
+
+    void add_soft(expr* e, unsigned w) {
+        m_soft.push_back(e);
+        m_weights.push_back(rational(w));
+    }
+
+    // cost of the optimal solution.
+    rational solve(params_ref const& p) {
+        opt::context ctx(m);
+        ctx.updt_params(p);
+        for (unsigned i = 0; i < m_hard.size(); ++i) {
+            ctx.add_hard_constraint(m_hard[i].get());
+        }
+        return solve(ctx, 0);
+    }
+
+    // add the soft constraints from index start on to ctx, and optimize.
+    rational solve(opt::context& ctx, unsigned start) {
+        unsigned idx = 0;
+        for (unsigned i = start; i < m_soft.size(); ++i) {
+            idx = ctx.add_soft_constraint(m_soft[i].get(), m_weights[i], symbol("soft"));
+        }
+        VERIFY(ctx.optimize() == l_true);
+        arith_util a(m);
+        rational lo, hi;
+        bool is_int;
+        VERIFY(a.is_numeral(ctx.get_lower(idx), lo, is_int));
+        VERIFY(a.is_numeral(ctx.get_upper(idx), hi, is_int));
+        VERIFY(lo == hi);
+        return lo;
+    }
+};
+
+// bounded integers with random linear soft constraints.
+static void mk_lia_instance(maxsmt_instance& inst, random_gen& r) {
+    ast_manager& m = inst.m;
+    arith_util a(m);
+    const unsigned n = 6;
+    expr_ref_vector xs(m);
+    for (unsigned i = 0; i < n; ++i) {
+        std::ostringstream strm;
+        strm << "x" << i;
+        expr* x = m.mk_const(symbol(strm.str().c_str()), a.mk_int());
+        xs.push_back(x);
+        inst.m_hard.push_back(a.mk_ge(x, a.mk_numeral(rational(0), true)));
+        inst.m_hard.push_back(a.mk_le(x, a.mk_numeral(rational(5), true)));
+    }
+    inst.m_hard.push_back(a.mk_le(a.mk_add(xs.size(), xs.c_ptr()), a.mk_numeral(rational(2*n), true)));
+    for (unsigned i = 0; i < n; ++i) {
+        expr* x = xs[i].get(), *y = xs[(i + 1) % n].get(), *z = xs[r(n)].get();
+        inst.add_soft(a.mk_ge(x, a.mk_numeral(rational(2 + r(4)), true)), 1 + r(5));
+        inst.add_soft(a.mk_le(a.mk_add(x, y), a.mk_numeral(rational(r(6)), true)), 1 + r(3));
+        inst.add_soft(m.mk_eq(x, a.mk_add(z, a.mk_numeral(rational(1), true))), 1 + r(2));
+    }
+}
+
+// extracting cores with several threads does not change the optimum.
+static void tst_maxres_threads() {
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        ast_manager m;
+        reg_decl_plugins(m);
+        random_gen r(seed);
+        maxsmt_instance inst(m);
+        mk_lia_instance(inst, r);
+        params_ref p1, p2;
+        p2.set_uint("maxres.threads", 2);
+        rational c1 = inst.solve(p1);
+        rational c2 = inst.solve(p2);
+        std::cout << "lia maxsmt " << seed << ": " << c1 << " " << c2 << "\n";
+        VERIFY(c1 == c2);
+    }
+}
+
+// random clauses satisfied by a planted assignment, and weighted soft literals.
+static void mk_sat_instance(maxsmt_instance& inst, random_gen& r) {
+    ast_manager& m = inst.m;
+    const unsigned n = 12;
+    expr_ref_vector vs(m);
+    svector<bool> planted;
+    for (unsigned i = 0; i < n; ++i) {
+        std::ostringstream strm;
+        strm << "p" << i;
+        vs.push_back(m.mk_const(symbol(strm.str().c_str()), m.mk_bool_sort()));
+        planted.push_back(r(2) == 0);
+    }
+    for (unsigned i = 0; i < 3*n; ++i) {
+        expr_ref_vector lits(m);
+        bool sat = false;
+        unsigned v0 = 0;
+        for (unsigned j = 0; j < 3; ++j) {
+            unsigned v = r(n);
+            bool neg = r(2) == 0;
+            sat |= planted[v] != neg;
+            if (j == 0) v0 = v;
+            lits.push_back(neg ? m.mk_not(vs[v].get()) : vs[v].get());
+        }
+        if (!sat) {
+            lits[0] = planted[v0] ? vs[v0].get() : m.mk_not(vs[v0].get());
+        }
+        inst.m_hard.push_back(m.mk_or(lits.size(), lits.c_ptr()));
+    }
+    for (unsigned i = 0; i < 2*n; ++i) {
+        expr* v = vs[r(n)].get();
+        inst.add_soft(r(2) == 0 ? m.mk_not(v) : v, 1 + r(9));
+    }
+}
+
+// the core-guided engine of the SAT core agrees with the maxres loop.
+static void tst_sat_maxsat() {
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        ast_manager m;
+        reg_decl_plugins(m);
+        random_gen r(seed);
+        maxsmt_instance inst(m);
+        mk_sat_instance(inst, r);
+        if (seed % 2 == 0) {
+            // duplicate soft literals, one with the complementary literal.
+            inst.add_soft(inst.m_soft[0].get(), 3);
+            inst.add_soft(inst.m_soft[1].get(), 2);
+            inst.add_soft(m.mk_not(inst.m_soft[1].get()), 4);
+        }
+        if (seed % 3 == 0) {
+            // a singleton core.
+            expr* v = m.mk_const(symbol("q"), m.mk_bool_sort());
+            inst.m_hard.push_back(v);
+            inst.add_soft(m.mk_not(v), 5);
+        }
+        params_ref loop, engine, no_exhaust;
+        // hill climbing in the loop can report a lower bound above the
+        // optimum on these instances; compare against the plain loop.
+        loop.set_bool("maxres.sat_core_guided", false);
+        loop.set_bool("maxres.hill_climb", false);
+        engine.set_bool("maxres.sat_core_guided", true);
+        no_exhaust.set_bool("maxres.sat_core_guided", true);
+        no_exhaust.set_bool("maxres.sat_exhaust_cores", false);
+        rational c1 = inst.solve(loop);
+        rational c2 = inst.solve(engine);
+        rational c3 = inst.solve(no_exhaust);
+        std::cout << "maxsat " << seed << ": " << c1 << " " << c2 << " " << c3 << "\n";
+        VERIFY(c1 == c2);
+        VERIFY(c1 == c3);
+    }
+}
+
+// later calls of an incremental context start from the previous optimum.
+static void tst_maxres_incremental() {
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        ast_manager m;
+        reg_decl_plugins(m);
+        random_gen r(seed);
+        maxsmt_instance inst(m);
+        mk_lia_instance(inst, r);
+        params_ref p;
+        p.set_bool("incremental", true);
+        opt::context ctx(m);
+        ctx.updt_params(p);
+        for (unsigned i = 0; i < inst.m_hard.size(); ++i) {
+            ctx.add_hard_constraint(inst.m_hard[i].get());
+        }
+        unsigned sz = inst.m_soft.size();
+        rational c1 = inst.solve(ctx, 0);
+        VERIFY(c1 == inst.solve(params_ref()));
+        // a second round of soft constraints, over the same hard constraints.
+        mk_lia_instance(inst, r);
+        rational c2 = inst.solve(ctx, sz);
+        VERIFY(c2 == inst.solve(params_ref()));
+        std::cout << "incremental lia maxsmt " << seed << ": " << c1 << " " << c2 << "\n";
+    }
+}
+
+void tst_maxres() {
+    tst_maxres_threads();
+    tst_maxres_incremental();
+    tst_sat_maxsat();
+}
@@ -479,6 +479,103 @@ static void tst5() {
     std::cout << "INT_MAX/4 -> " << m.log2(a) << "\n";
 }
 
+static void tst_bitwise64() {
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m);
+    uint64 u = 0xF0F0F0F0F0F0F0F0ull, v = 0x123456789ABCDEF0ull;
+    m.set(a, u);
+    m.set(b, v);
+    m.bitwise_or(a, b, c);
+    SASSERT(m.get_uint64(c) == (u | v));
+    m.bitwise_and(a, b, c);
+    SASSERT(m.get_uint64(c) == (u & v));
+    m.bitwise_xor(a, b, c);
+    SASSERT(m.get_uint64(c) == (u ^ v));
+    m.bitwise_not(64, a, c);
+    SASSERT(m.get_uint64(c) == ~u);
+    m.bitwise_not(40, b, c);
+    SASSERT(m.get_uint64(c) == (~v & ((1ull << 40) - 1ull)));
+    m.bitwise_xor(a, a, c);
+    SASSERT(m.is_zero(c));
+}
+
+static void tst_int64_ops() {
+    // values that are not small (do not fit in an int) but fit in a machine word.
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m), d(m), g(m);
+    int64 vals[] = { 3000000000ll, -3000000000ll, 1ll << 40, -(1ll << 40), 4611686018427387904ll, 
+                     -4611686018427387903ll, 123456789012345ll, 7, -7, 0, INT_MAX, INT_MIN };
+    unsigned n = sizeof(vals)/sizeof(vals[0]);
+    for (unsigned i = 0; i < n; ++i) {
+        for (unsigned j = 0; j < n; ++j) {
+            m.set(a, vals[i]);
+            m.set(b, vals[j]);
+            m.add(a, b, c);
+            m.sub(c, b, d);
+            SASSERT(m.eq(a, d));
+            m.mul(a, b, c);
+            if (!m.is_zero(b)) {
+                m.machine_div(c, b, d);
+                SASSERT(m.eq(a, d));
+                m.rem(c, b, d);
+                SASSERT(m.is_zero(d));
+            }
+            m.gcd(a, b, g);
+            if (!m.is_zero(g)) {
+                m.rem(a, g, d);
+                SASSERT(m.is_zero(d));
+                m.rem(b, g, d);
+                SASSERT(m.is_zero(d));
+            }
+        }
+    }
+}
+
+static void tst_int64_min() {
+    // results equal to INT64_MIN do not fit the machine word path.
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m), d(m);
+    int64 h = -(1ll << 62);
+    m.set(a, h);
+    m.add(a, a, c);
+    m.set(d, h);
+    m.mul2k(d, 1);
+    VERIFY(m.eq(c, d));
+    m.set(b, 1ll << 62);
+    m.sub(a, b, c);
+    VERIFY(m.eq(c, d));
+    m.set(b, 2);
+    m.mul(a, b, c);
+    VERIFY(m.eq(c, d));
+    m.neg(c);
+    VERIFY(m.is_uint64(c) && m.get_uint64(c) == (1ull << 63));
+}
+
+// mpz_bench [iterations]: time add/mul/div on values between 2^31 and 2^63.
+void tst_mpz_bench(char ** argv, int argc, int& i) {
+    unsigned num_iterations = 1000000;
+    if (i + 1 < argc && argv[i + 1][0] != '/' && argv[i + 1][0] != '-') {
+        num_iterations = atoi(argv[++i]);
+    }
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m), n(m), expected(m);
+    m.set(a, 3000000000ll);
+    m.set(b, 7ll);
+    m.set(c, a);
+    {
+        timeit tt(true, "int64 mpz add/mul/div");
+        for (unsigned k = 0; k < num_iterations; ++k) {
+            m.mul(c, b, c);
+            m.add(c, b, c);
+            m.machine_div(c, b, c);
+        }
+    }
+    // each round computes (c*7 + 7)/7 = c + 1.
+    m.set(n, num_iterations);
+    m.add(a, n, expected);
+    VERIFY(m.eq(c, expected));
+}
+
 static void tst_pw2() {
     unsynch_mpz_manager m;
     scoped_mpz a(m);
@@ -492,6 +589,9 @@ void tst_mpz() {
     disable_trace("mpz");
     enable_trace("mpz_2k");
     tst_pw2();
+    tst_bitwise64();
+    tst_int64_ops();
+    tst_int64_min();
     tst5();
     tst_div2k_bug();
     rand_tst_gcd(50, 3, 2);
@@ -696,7 +696,49 @@ static void tst10() {
     std::cout << "\n";
 }
 
+static lbool check_reordered(bool root_cache, int k) {
+    params_ref      ps;
+    ps.set_bool("reorder", true);
+    ps.set_bool("root_cache", root_cache);
+    reslimit        rlim;
+    nlsat::solver s(rlim, ps);
+    nlsat::pmanager & pm  = s.pm();
+    nlsat::var _x = s.mk_var(false);
+    nlsat::var _y = s.mk_var(false);
+    nlsat::var _z = s.mk_var(false);
+    polynomial_ref x(pm), y(pm), z(pm), p(pm);
+    x = pm.mk_polynomial(_x);
+    y = pm.mk_polynomial(_y);
+    z = pm.mk_polynomial(_z);
+    nlsat::literal lits[1];
+    // x*y > 1, z^3 - x - y > 0, k - x^2 - y^2 - z^2 > 0
+    p = x*y - 1;
+    lits[0] = mk_gt(s, p);
+    s.mk_clause(1, lits);
+    p = z*z*z - x - y;
+    lits[0] = mk_gt(s, p);
+    s.mk_clause(1, lits);
+    p = -(x*x) - y*y - z*z + k;
+    lits[0] = mk_gt(s, p);
+    s.mk_clause(1, lits);
+    lbool r = s.check();
+    // the second check renames the polynomials again.
+    VERIFY(s.check() == r);
+    return r;
+}
+
+// the root cache does not survive variable reordering.
+static void tst11() {
+    for (int k = 1; k <= 6; ++k) {
+        lbool r = check_reordered(false, k);
+        std::cout << "k: " << k << " " << r << "\n";
+        VERIFY(check_reordered(true, k) == r);
+    }
+}
+
 void tst_nlsat() {
+    tst11();
+    std::cout << "------------------\n";
     tst10();
     std::cout << "------------------\n";
     exit(0);
@@ -0,0 +1,98 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    obj_mark.cpp
+
+Abstract:
+
+    Test epoch-stamped object marks.
+
+Author:
+
+    Z3 developers 2016-10-19.
+
+Revision History:
+
+--*/
+#include"obj_mark.h"
+#include"ast.h"
+#include"reg_decl_plugins.h"
+#include"used_vars.h"
+#include"has_free_vars.h"
+#include"for_each_expr.h"
+
+struct tst_obj {
+    unsigned m_id;
+    tst_obj(unsigned id):m_id(id) {}
+    unsigned get_id() const { return m_id; }
+};
+
+static void tst1() {
+    obj_stamp_mark<tst_obj> marks;
+    tst_obj a(0), b(7), c(1000);
+    SASSERT(!marks.is_marked(a));
+    marks.mark(a);
+    marks.mark(c);
+    SASSERT(marks.is_marked(a));
+    SASSERT(!marks.is_marked(b));
+    SASSERT(marks.is_marked(c));
+    marks.mark(c, false);
+    SASSERT(!marks.is_marked(c));
+    marks.reset();
+    SASSERT(!marks.is_marked(a));
+    marks.mark(b);
+    SASSERT(marks.is_marked(b));
+    SASSERT(!marks.is_marked(a));
+}
+
+struct count_proc {
+    unsigned m_count;
+    count_proc():m_count(0) {}
+    void operator()(var * n)        { m_count++; }
+    void operator()(app * n)        { m_count++; }
+    void operator()(quantifier * n) { m_count++; }
+};
+
+static void tst2() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    sort * s = m.mk_bool_sort();
+    func_decl_ref f(m.mk_func_decl(symbol("f"), s, s, s), m);
+    expr_ref x(m.mk_var(0, s), m), y(m.mk_var(1, s), m);
+    expr_ref fxy(m.mk_app(f.get(), x.get(), y.get()), m);
+    expr_ref t(m.mk_app(f.get(), fxy.get(), fxy.get()), m);
+    symbol n("z");
+    expr_ref q(m.mk_forall(1, &s, &n, t), m);
+    expr_ref g(m.mk_app(f.get(), q.get(), y.get()), m);
+
+    for (unsigned k = 0; k < 2; ++k) {
+        used_vars uv(k == 1);
+        for (unsigned i = 0; i < 3; ++i) {
+            // reuse the same functor to exercise the epoch reset.
+            uv(t);
+            SASSERT(uv.get_max_found_var_idx_plus_1() == 2);
+            uv(g);
+            SASSERT(uv.get_max_found_var_idx_plus_1() == 2);
+            SASSERT(uv.contains(0));
+            SASSERT(uv.contains(1));
+        }
+    }
+    SASSERT(has_free_vars(t));
+    SASSERT(has_free_vars(g));
+    SASSERT(!has_free_vars(m.mk_forall(1, &s, &n, m.mk_app(f.get(), x.get(), x.get()))));
+
+    expr_stamp_mark visited;
+    for (unsigned i = 0; i < 3; ++i) {
+        count_proc proc;
+        visited.reset();
+        for_each_expr(proc, visited, t);
+        SASSERT(proc.m_count == 4);
+    }
+}
+
+void tst_obj_mark() {
+    tst1();
+    tst2();
+}
@@ -0,0 +1,121 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+--*/
+
+#include "opt_context.h"
+#include "reg_decl_plugins.h"
+#include "arith_decl_plugin.h"
+
+typedef vector<rational> point;
+
+struct point_lt {
+    bool operator()(point const& a, point const& b) const {
+        for (unsigned i = 0; i < a.size() && i < b.size(); ++i) {
+            if (a[i] != b[i]) return a[i] < b[i];
+        }
+        return a.size() < b.size();
+    }
+};
+
+// objectives and hard constraints of an instance, and the terms that give the
+// value of each objective in a model.
+typedef void (*mk_instance)(opt::context& ctx, expr_ref_vector& values);
+
+static expr* mk_int(ast_manager& m, char const* name) {
+    arith_util a(m);
+    return m.mk_const(symbol(name), a.mk_int());
+}
+
+static void add_range(opt::context& ctx, expr* x, int lo, int hi) {
+    arith_util a(ctx.get_manager());
+    ctx.add_hard_constraint(a.mk_ge(x, a.mk_numeral(rational(lo), true)));
+    ctx.add_hard_constraint(a.mk_le(x, a.mk_numeral(rational(hi), true)));
+}
+
+// three competing arithmetic objectives.
+static void mk_arith_instance(opt::context& ctx, expr_ref_vector& values) {
+    ast_manager& m = ctx.get_manager();
+    arith_util a(m);
+    expr* x = mk_int(m, "x"), *y = mk_int(m, "y"), *z = mk_int(m, "z");
+    add_range(ctx, x, 0, 3);
+    add_range(ctx, y, 0, 3);
+    add_range(ctx, z, 0, 3);
+    expr* args[3] = { x, y, z };
+    ctx.add_hard_constraint(a.mk_le(a.mk_add(3, args), a.mk_numeral(rational(4), true)));
+    ctx.add_objective(to_app(x), true);
+    ctx.add_objective(to_app(y), true);
+    ctx.add_objective(to_app(a.mk_sub(z, x)), false);
+    values.push_back(x);
+    values.push_back(y);
+    values.push_back(a.mk_sub(z, x));
+}
+
+// two MaxSMT objectives that pull the same atoms in opposite directions, and an
+// arithmetic objective.
+static void mk_maxsmt_instance(opt::context& ctx, expr_ref_vector& values) {
+    ast_manager& m = ctx.get_manager();
+    arith_util a(m);
+    expr* x = mk_int(m, "x");
+    add_range(ctx, x, 0, 4);
+    expr_ref_vector sum1(m), sum2(m);
+    expr* zero = a.mk_numeral(rational(0), false);
+    for (unsigned i = 0; i < 4; ++i) {
+        expr* atom = a.mk_ge(x, a.mk_numeral(rational(i + 1), true));
+        rational w1(i + 1), w2(4 - i);
+        ctx.add_soft_constraint(atom, w1, symbol("up"));
+        ctx.add_soft_constraint(m.mk_not(atom), w2, symbol("down"));
+        sum1.push_back(m.mk_ite(atom, a.mk_numeral(w1, false), zero));
+        sum2.push_back(m.mk_ite(atom, zero, a.mk_numeral(w2, false)));
+    }
+    expr* p = m.mk_const(symbol("p"), m.mk_bool_sort());
+    ctx.add_hard_constraint(m.mk_implies(p, a.mk_le(x, a.mk_numeral(rational(2), true))));
+    ctx.add_objective(to_app(m.mk_ite(p, a.mk_numeral(rational(3), true), a.mk_numeral(rational(0), true))), true);
+    values.push_back(a.mk_add(sum1.size(), sum1.c_ptr()));
+    values.push_back(a.mk_add(sum2.size(), sum2.c_ptr()));
+    values.push_back(m.mk_ite(p, a.mk_numeral(rational(3), true), a.mk_numeral(rational(0), true)));
+}
+
+static void get_front(mk_instance mk, unsigned num_threads, vector<point>& front) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    opt::context ctx(m);
+    params_ref p;
+    p.set_sym("priority", symbol("pareto"));
+    p.set_uint("pareto.threads", num_threads);
+    ctx.updt_params(p);
+    expr_ref_vector values(m);
+    mk(ctx, values);
+    arith_util a(m);
+    while (ctx.optimize() == l_true) {
+        model_ref mdl;
+        ctx.get_model(mdl);
+        point pt;
+        for (unsigned i = 0; i < values.size(); ++i) {
+            expr_ref val(m);
+            rational r;
+            VERIFY(mdl->eval(values[i].get(), val, true) && a.is_numeral(val, r));
+            pt.push_back(r);
+        }
+        front.push_back(pt);
+    }
+    std::sort(front.begin(), front.end(), point_lt());
+}
+
+// the fronts enumerated in parallel over boxes and by the sequential algorithm agree.
+static void tst_pareto_front(mk_instance mk) {
+    vector<point> front1, front2;
+    get_front(mk, 1, front1);
+    get_front(mk, 2, front2);
+    std::cout << "pareto front: " << front1.size() << " " << front2.size() << " points\n";
+    VERIFY(!front1.empty());
+    VERIFY(front1.size() == front2.size());
+    for (unsigned i = 0; i < front1.size(); ++i) {
+        VERIFY(!point_lt()(front1[i], front2[i]) && !point_lt()(front2[i], front1[i]));
+    }
+}
+
+void tst_opt_pareto() {
+    tst_pareto_front(mk_arith_instance);
+    tst_pareto_front(mk_maxsmt_instance);
+}
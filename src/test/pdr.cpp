@@ -6,6 +6,7 @@ Copyright (c) 2015 Microsoft Corporation
 
 #include "pdr_context.h"
 #include "reg_decl_plugins.h"
+#include "z3.h"
 
 
 using namespace pdr;
@@ -121,7 +122,51 @@ struct test_model_search {
 
 };
 
+static Z3_lbool pdr_query(char const* spec, bool cache_checks) {
+    Z3_config cfg = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context(cfg);
+    Z3_del_config(cfg);
+    Z3_fixedpoint fp = Z3_mk_fixedpoint(ctx);
+    Z3_fixedpoint_inc_ref(ctx, fp);
+    Z3_params p = Z3_mk_params(ctx);
+    Z3_params_inc_ref(ctx, p);
+    Z3_params_set_symbol(ctx, p, Z3_mk_string_symbol(ctx, "engine"), Z3_mk_string_symbol(ctx, "pdr"));
+    Z3_params_set_bool(ctx, p, Z3_mk_string_symbol(ctx, "pdr.cache_checks"), cache_checks);
+    Z3_fixedpoint_set_params(ctx, fp, p);
+    Z3_ast_vector queries = Z3_fixedpoint_from_string(ctx, fp, spec);
+    Z3_ast_vector_inc_ref(ctx, queries);
+    VERIFY(Z3_ast_vector_size(ctx, queries) == 1);
+    Z3_lbool r = Z3_fixedpoint_query(ctx, fp, Z3_ast_vector_get(ctx, queries, 0));
+    Z3_ast_vector_dec_ref(ctx, queries);
+    Z3_params_dec_ref(ctx, p);
+    Z3_fixedpoint_dec_ref(ctx, fp);
+    Z3_del_context(ctx);
+    return r;
+}
+
+static void tst_pdr_cache_checks() {
+    static char const* counter = 
+        "(declare-rel inv (Int Int))\n"
+        "(declare-rel err ())\n"
+        "(declare-var x Int)\n"
+        "(declare-var y Int)\n"
+        "(rule (=> (and (= x 0) (= y 0)) (inv x y)))\n"
+        "(rule (=> (and (inv x y) (< x 10)) (inv (+ x 1) (+ y 2))))\n";
+    std::string safe(counter), unsafe(counter), deep(counter);
+    safe   += "(rule (=> (and (inv x y) (or (> x 10) (and (= x 10) (not (= y 20))))) err))\n(query err)\n";
+    unsafe += "(rule (=> (and (inv x y) (= y 8)) err))\n(query err)\n";
+    deep   += "(rule (=> (and (inv x y) (= x 10) (= y 20)) err))\n(query err)\n";
+    for (unsigned k = 0; k < 2; ++k) {
+        bool cache_checks = k == 1;
+        VERIFY(pdr_query(safe.c_str(), cache_checks) == Z3_L_FALSE);
+        VERIFY(pdr_query(unsafe.c_str(), cache_checks) == Z3_L_TRUE);
+        VERIFY(pdr_query(deep.c_str(), cache_checks) == Z3_L_TRUE);
+    }
+}
+
 void tst_pdr() {
+    tst_pdr_cache_checks();
+
     test_model_search test;
 
     test.init();
@@ -23,6 +23,7 @@ Notes:
 #include"polynomial_cache.h"
 #include"linear_eq_solver.h"
 #include"rlimit.h"
+#include"timeit.h"
 
 static void tst1() {
     std::cout << "\n----- Basic testing -------\n";
@@ -1812,6 +1813,108 @@ static void tst_divides() {
     std::cout << "divides(q, p): " << m.divides(q, p) << "\n";
 }
 
+static void tst_vars_mask() {
+    // variables x and x + 64 share a bit in the packed variable mask of monomials.
+    polynomial::numeral_manager nm;
+    reslimit rl; polynomial::manager m(rl, nm);
+    polynomial::var xs[130];
+    for (unsigned i = 0; i < 130; i++)
+        xs[i] = m.mk_var();
+    polynomial::monomial_ref m1(m), m2(m), m3(m), q1(m), q2(m), r(m), y1(m);
+    y1 = m.mk_monomial(xs[1]);
+    r  = m.mk_monomial(xs[0], 2);
+    m1 = m.mul(r, y1);
+    r  = m.mk_monomial(xs[64]);
+    m2 = m.mul(r, y1);
+    r  = m.mk_monomial(xs[128], 3);
+    q1 = m.mk_monomial(xs[65]);
+    m3 = m.mul(r, q1);
+    SASSERT(m.degree_of(m1, xs[0]) == 2);
+    SASSERT(m.degree_of(m1, xs[64]) == 0);
+    SASSERT(m.degree_of(m1, xs[128]) == 0);
+    SASSERT(m.degree_of(m3, xs[128]) == 3);
+    SASSERT(m.degree_of(m3, xs[1]) == 0);
+    SASSERT(!m.div(m1, m2));
+    SASSERT(!m.div(m2, m1));
+    SASSERT(!m.div(m3, m1));
+    polynomial::monomial * _q1, * _q2;
+    r = m.mul(m1, m2);
+    SASSERT(m.div(r, m2));
+    r = m.mul(m1, m3);
+    SASSERT(m.div(r, m3, _q1) && _q1 == m1);
+    polynomial::monomial_ref g(m);
+    g = m.gcd(m1, m3, _q1, _q2);
+    q1 = _q1; q2 = _q2;
+    SASSERT(g == m.mk_unit() && q1 == m3 && q2 == m1);
+    g = m.gcd(m1, m2, _q1, _q2);
+    q1 = _q1; q2 = _q2;
+    SASSERT(g == y1);
+    polynomial_ref x0(m), x64(m), x128(m), p(m);
+    x0   = m.mk_polynomial(xs[0]);
+    x64  = m.mk_polynomial(xs[64]);
+    x128 = m.mk_polynomial(xs[128]);
+    p = x128 * x0 + x64;
+    SASSERT(m.degree(p, xs[128]) == 1);
+    SASSERT(m.degree(p, xs[1]) == 0);
+    std::cout << "vars mask: " << p << "\n";
+}
+
+static void tst_modular_psc(polynomial_ref const & p, polynomial_ref const & q, polynomial::var x) {
+    polynomial::manager & m = p.m();
+    polynomial_ref r1(m), r2(m);
+    polynomial_ref_vector S1(m), S2(m);
+    std::cout << "---------" << std::endl;
+    std::cout << "p: " << p << std::endl;
+    std::cout << "q: " << q << std::endl;
+    {
+        timeit timer(true, "modular psc");
+        m.set_modular_psc(true);
+        m.resultant(p, q, x, r1);
+        m.psc_chain(p, q, x, S1);
+    }
+    {
+        timeit timer(true, "integer psc");
+        m.set_modular_psc(false);
+        m.resultant(p, q, x, r2);
+        m.psc_chain(p, q, x, S2);
+    }
+    m.set_modular_psc(true);
+    std::cout << "resultant: " << r1 << std::endl;
+    SASSERT(m.eq(r1, r2));
+    SASSERT(S1.size() == S2.size());
+    for (unsigned i = 0; i < S1.size(); i++) {
+        SASSERT(m.eq(S1.get(i), S2.get(i)));
+    }
+}
+
+static void tst_modular_psc() {
+    reslimit rl;
+    polynomial::numeral_manager nm;
+    polynomial::manager m(rl, nm);
+    polynomial_ref x(m), y(m);
+    x = m.mk_polynomial(m.mk_var());
+    y = m.mk_polynomial(m.mk_var());
+    tst_modular_psc((x^4) + 3*(x^2) + 5*x + 3, 4*(x^3) + 6*x + 5, 0);
+    tst_modular_psc(2*x + 3, (x^5) - 7*(x^2) + 1, 0);
+    // common factor: the resultant and some principal subresultant coefficients are zero
+    tst_modular_psc((x - 1)*((x^3) + 2*x + 5), (x - 1)*(x + 3)*(4*(x^2) - 9), 0);
+    tst_modular_psc(((x^2) + 1)*(x - 2)*(x + 5), ((x^2) + 1)*(3*(x^3) - x + 1), 0);
+    // large coefficients, and leading coefficients that vanish modulo some primes
+    polynomial_ref c(m);
+    c = m.mk_const(rational("1000000007000000063"));
+    tst_modular_psc(c*(x^5) - 123456789*(x^3) + x - 1, 39103*(x^4) + c*x - 987654321, 0);
+    // multivariate polynomials are handled by the integer algorithm
+    tst_modular_psc(((y^2) + 6)*(x - 1) - y*((x^2) + 1), ((x^2) + 6)*(y - 1) - x*((y^2) + 1), 0);
+    polynomial_ref p(m), q(m);
+    p = m.mk_zero();
+    q = m.mk_zero();
+    for (int i = 0; i <= 40; i++) {
+        p = p + ((i*7919 % 1000003) - 500000)*(x^i);
+        q = q + ((i*104729 % 1000033) - 480000)*(x^i);
+    }
+    tst_modular_psc(p, q, 0);
+}
+
 void tst_polynomial() {
     set_verbosity_level(1000);
     // enable_trace("factor");
@@ -1822,6 +1925,8 @@ void tst_polynomial() {
     enable_trace("Lazard");
     // enable_trace("eval_bug");
     // enable_trace("mgcd");
+    tst_vars_mask();
+    tst_modular_psc();
     tst_psc();
     return;
     tst_eval();
@@ -5,6 +5,7 @@ Copyright (c) 2015 Microsoft Corporation
 --*/
 
 #include "tbv.h"
+#include "stopwatch.h"
 
 static void tst1(unsigned num_bits) {
     tbv_manager m(num_bits);
@@ -74,6 +75,40 @@ static void tst2(unsigned num_bits) {
     }
 }
 
+static tbv* mk_random(tbv_manager& m, random_gen& r, bool allow_z) {
+    tbv* t = m.allocateX();
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        switch (r(16)) {
+        case 0: m.set(*t, i, BIT_0); break;
+        case 1: m.set(*t, i, BIT_1); break;
+        case 2: if (allow_z) m.set(*t, i, BIT_z); break;
+        default: break;
+        }
+    }
+    return t;
+}
+
+// the vectorized operations agree with the scalar ones.
+static void tst3(unsigned num_bits) {
+    tbv_manager ms(num_bits, false);
+    tbv_manager mv(num_bits, true);
+    random_gen r(num_bits);
+    for (unsigned k = 0; k < 200; ++k) {
+        tbv_ref a(mv, mk_random(mv, r, k % 4 == 0)), b(mv, mk_random(mv, r, false));
+        if (k % 3 == 0) {
+            mv.copy(*b, *a);
+            if (k % 2 == 0) mv.set(*b, r(num_bits), BIT_x);
+        }
+        VERIFY(ms.equals(*a, *b) == mv.equals(*a, *b));
+        VERIFY(ms.contains(*a, *b) == mv.contains(*a, *b));
+        VERIFY(ms.contains(*b, *a) == mv.contains(*b, *a));
+        VERIFY(ms.is_well_formed(*a) == mv.is_well_formed(*a));
+        tbv_ref c(mv, mv.allocate(*a)), d(mv, mv.allocate(*a));
+        VERIFY(ms.set_and(*c, *b) == mv.set_and(*d, *b));
+        VERIFY(ms.equals(*c, *d));
+    }
+}
+
 void tst_tbv() {
     tst0();
     
@@ -88,4 +123,66 @@ void tst_tbv() {
     tst2(15);
     tst2(16);
     tst2(17);
+
+    tst3(17);
+    tst3(64);
+    tst3(129);
+    tst3(300);
+}
+
+// tbv_bench [num_bits]: time the scalar and the vectorized tbv operations.
+void tst_tbv_bench(char ** argv, int argc, int& i) {
+    unsigned num_bits = 256;
+    if (i + 1 < argc && argv[i + 1][0] != '/' && argv[i + 1][0] != '-') {
+        num_bits = atoi(argv[++i]);
+    }
+    const unsigned num_tbvs = 1000, rounds = 200;
+    for (unsigned simd = 0; simd < 2; ++simd) {
+        tbv_manager m(num_bits, simd != 0);
+        random_gen r(0);
+        ptr_vector<tbv> tbvs;
+        for (unsigned k = 0; k < num_tbvs; ++k) {
+            tbvs.push_back(mk_random(m, r, false));
+        }
+        tbv_ref tmp(m, m.allocate());
+        unsigned count = 0;
+        stopwatch sw_and, sw_eq, sw_contains, sw_wf;
+        sw_and.start();
+        for (unsigned j = 0; j < rounds; ++j) {
+            for (unsigned k = 0; k + 1 < num_tbvs; ++k) {
+                m.copy(*tmp, *tbvs[k]);
+                count += m.set_and(*tmp, *tbvs[k + 1]);
+            }
+        }
+        sw_and.stop();
+        sw_eq.start();
+        for (unsigned j = 0; j < rounds; ++j) {
+            for (unsigned k = 0; k < num_tbvs; ++k) {
+                count += m.equals(*tbvs[k], *tbvs[(k + j) % num_tbvs]);
+            }
+        }
+        sw_eq.stop();
+        sw_contains.start();
+        for (unsigned j = 0; j < rounds; ++j) {
+            for (unsigned k = 0; k < num_tbvs; ++k) {
+                count += m.contains(*tbvs[k], *tbvs[(k + j) % num_tbvs]);
+            }
+        }
+        sw_contains.stop();
+        sw_wf.start();
+        for (unsigned j = 0; j < rounds; ++j) {
+            for (unsigned k = 0; k < num_tbvs; ++k) {
+                count += m.is_well_formed(*tbvs[k]);
+            }
+        }
+        sw_wf.stop();
+        std::cout << "simd level " << m.simd_level() << " (" << num_bits << " bits, checksum " << count << "):"
+                  << " set_and " << sw_and.get_seconds() << "s"
+                  << " equals " << sw_eq.get_seconds() << "s"
+                  << " contains " << sw_contains.get_seconds() << "s"
+                  << " is_well_formed " << sw_wf.get_seconds() << "s\n";
+        for (unsigned k = 0; k < num_tbvs; ++k) {
+            m.deallocate(tbvs[k]);
+        }
+    }
 }
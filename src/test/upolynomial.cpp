@@ -17,6 +17,7 @@ Notes:
 
 --*/
 #include"upolynomial.h"
+#include"upolynomial_factorization.h"
 #include"timeit.h"
 #include"rlimit.h"
 
@@ -1056,6 +1057,45 @@ static void tst_lower_bound() {
     tst_lower_bound((((x^5) - 1000000000)^3)*((3*x - 10000000)^2)*((10*x - 632)^2));
 }
 
+static void tst_fact_cache(polynomial_ref const & p, unsigned num_distinct_factors) {
+    std::cout << "---------------\n";
+    std::cout << "p: " << p << std::endl;
+    reslimit rl; upolynomial::manager um(rl, p.m().m());
+    upolynomial::factorization_cache cache(um);
+    upolynomial::scoped_numeral_vector _p(um), _r(um);
+    um.to_numeral_vector(p, _p);
+    for (unsigned i = 0; i < 2; i++) {
+        upolynomial::factors fs(um);
+        {
+            timeit timer(true, i == 0 ? "factor" : "cached factor");
+            cache.factor(_p, fs);
+        }
+        std::cout << "factors: " << fs << std::endl;
+        SASSERT(fs.distinct_factors() == num_distinct_factors);
+        fs.multiply(_r);
+        SASSERT(um.eq(_p, _r));
+    }
+    SASSERT(cache.hits() == 1 && cache.misses() == 1);
+    cache.reset();
+    SASSERT(cache.size() == 0);
+}
+
+static void tst_fact_cache() {
+    reslimit rl;
+    polynomial::numeral_manager nm;
+    polynomial::manager m(rl, nm);
+    polynomial_ref x0(m);
+    x0 = m.mk_polynomial(m.mk_var());
+    // Swinnerton-Dyer polynomial: irreducible, but it has 8 modular factors for every prime
+    tst_fact_cache((x0^16) - 136*(x0^14) + 6476*(x0^12) - 141912*(x0^10) + 1513334*(x0^8) - 7453176*(x0^6) + 13950764*(x0^4) - 5596840*(x0^2) + 46225, 1);
+    // many modular factors, most of them are real factors
+    polynomial_ref p(m);
+    p = (x0^4) - 10*(x0^2) + 1;
+    for (int i = 1; i <= 12; i++)
+        p = p * (3*x0 - i);
+    tst_fact_cache(p, 13);
+}
+
 void tst_upolynomial() {
     set_verbosity_level(1000);
     enable_trace("mpz_gcd");
@@ -1067,6 +1107,7 @@ void tst_upolynomial() {
     tst_gcd();
     tst_lower_bound();
     tst_fact();
+    tst_fact_cache();
     tst_rem();
     tst_exact_div();
     tst_isolate_roots5();
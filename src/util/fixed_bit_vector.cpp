@@ -24,6 +24,152 @@ Revision History:
 #include"trace.h"
 #include"hash.h"
 
+// SSE2 is part of every x64 processor. AVX2 kernels are compiled for GCC and clang
+// only, and are used when the processor supports them.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FBV_SSE2
+#include<emmintrin.h>
+#endif
+
+#if defined(FBV_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define FBV_AVX2
+#include<immintrin.h>
+#define FBV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// The kernels below process a prefix of the n words, and return the number of words
+// processed. The callers finish the remaining words with scalar code.
+
+#ifdef FBV_SSE2
+static unsigned sse2_and(unsigned * dst, unsigned const * src, unsigned n) {
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(d, s));
+    }
+    return i;
+}
+
+static unsigned sse2_or(unsigned * dst, unsigned const * src, unsigned n) {
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(d, s));
+    }
+    return i;
+}
+
+// stops at the first block where a and b differ.
+static unsigned sse2_equal_prefix(unsigned const * a, unsigned const * b, unsigned n) {
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)) != 0xFFFF) break;
+    }
+    return i;
+}
+
+// stops at the first block where b is not contained in a.
+static unsigned sse2_contains_prefix(unsigned const * a, unsigned const * b, unsigned n) {
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(x, y), y)) != 0xFFFF) break;
+    }
+    return i;
+}
+
+// stops at the first block with a pair of bits that are both 0.
+static unsigned sse2_pairs_prefix(unsigned const * a, unsigned n) {
+    __m128i odd = _mm_set1_epi32(0x55555555);
+    __m128i ones = _mm_set1_epi32(-1);
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        x = _mm_or_si128(_mm_or_si128(x, _mm_slli_epi32(x, 1)), odd);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, ones)) != 0xFFFF) break;
+    }
+    return i;
+}
+#endif
+
+#ifdef FBV_AVX2
+FBV_TARGET_AVX2
+static unsigned avx2_and(unsigned * dst, unsigned const * src, unsigned n) {
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(d, s));
+    }
+    return i;
+}
+
+FBV_TARGET_AVX2
+static unsigned avx2_or(unsigned * dst, unsigned const * src, unsigned n) {
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(d, s));
+    }
+    return i;
+}
+
+FBV_TARGET_AVX2
+static unsigned avx2_equal_prefix(unsigned const * a, unsigned const * b, unsigned n) {
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y)) != -1) break;
+    }
+    return i;
+}
+
+FBV_TARGET_AVX2
+static unsigned avx2_contains_prefix(unsigned const * a, unsigned const * b, unsigned n) {
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(x, y), y)) != -1) break;
+    }
+    return i;
+}
+
+FBV_TARGET_AVX2
+static unsigned avx2_pairs_prefix(unsigned const * a, unsigned n) {
+    __m256i odd = _mm256_set1_epi32(0x55555555);
+    __m256i ones = _mm256_set1_epi32(-1);
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        x = _mm256_or_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 1)), odd);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, ones)) != -1) break;
+    }
+    return i;
+}
+
+static bool has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}
+#endif
+
+#ifdef FBV_AVX2
+#define FBV_DISPATCH(_avx2, _sse2, _args) (m_simd == 2 ? _avx2 _args : m_simd == 1 ? _sse2 _args : 0)
+#elif defined(FBV_SSE2)
+#define FBV_DISPATCH(_avx2, _sse2, _args) (m_simd == 1 ? _sse2 _args : 0)
+#else
+#define FBV_DISPATCH(_avx2, _sse2, _args) 0
+#endif
+
 void fixed_bit_vector::set(fixed_bit_vector const& other, unsigned hi, unsigned lo) {
     if ((lo % 32) == 0) {
         unsigned sz32 = (hi-lo+1)/32;
@@ -41,7 +187,7 @@ void fixed_bit_vector::set(fixed_bit_vector const& other, unsigned hi, unsigned
     }
 }
 
-fixed_bit_vector_manager::fixed_bit_vector_manager(unsigned num_bits):
+fixed_bit_vector_manager::fixed_bit_vector_manager(unsigned num_bits, bool use_simd):
     m_alloc("fixed_bit_vector") {
     m_num_bits = num_bits;
     m_num_words = num_words(num_bits);
@@ -49,6 +195,18 @@ fixed_bit_vector_manager::fixed_bit_vector_manager(unsigned num_bits):
     unsigned bit_rest = m_num_bits % 32;
     m_mask = (1U << bit_rest) - 1;
     if (m_mask == 0) m_mask = UINT_MAX;
+    m_simd = 0;
+#ifdef FBV_SSE2
+    if (use_simd) {
+        m_simd = 1;
+    }
+#endif
+#ifdef FBV_AVX2
+    static bool avx2 = has_avx2();
+    if (use_simd && avx2) {
+        m_simd = 2;
+    }
+#endif
 }
 
 
@@ -99,14 +257,16 @@ fixed_bit_vector_manager::fill1(fixed_bit_vector& bv) const {
 
 fixed_bit_vector& 
 fixed_bit_vector_manager::set_and(fixed_bit_vector& dst, fixed_bit_vector const& src) const {
-    for (unsigned i = 0; i < m_num_words; i++) 
+    unsigned i = FBV_DISPATCH(avx2_and, sse2_and, (dst.m_data, src.m_data, m_num_words));
+    for (; i < m_num_words; i++) 
         dst.m_data[i] &= src.m_data[i];
     return dst;
 }
 
 fixed_bit_vector& 
 fixed_bit_vector_manager::set_or(fixed_bit_vector& dst,  fixed_bit_vector const& src) const {
-    for (unsigned i = 0; i < m_num_words; i++) 
+    unsigned i = FBV_DISPATCH(avx2_or, sse2_or, (dst.m_data, src.m_data, m_num_words));
+    for (; i < m_num_words; i++) 
         dst.m_data[i] |= src.m_data[i];
     return dst;
 }
@@ -129,7 +289,8 @@ bool fixed_bit_vector_manager::equals(fixed_bit_vector const& a, fixed_bit_vecto
     unsigned n = num_words();
     if (n == 0)
         return true;
-    for (unsigned i = 0; i < n - 1; i++) {
+    unsigned i = FBV_DISPATCH(avx2_equal_prefix, sse2_equal_prefix, (a.m_data, b.m_data, n - 1));
+    for (; i < n - 1; i++) {
         if (a.m_data[i] != b.m_data[i])
             return false;
     }
@@ -144,7 +305,8 @@ bool fixed_bit_vector_manager::contains(fixed_bit_vector const& a, fixed_bit_vec
     if (n == 0)
         return true;
     
-    for (unsigned i = 0; i < n - 1; ++i) {
+    unsigned i = FBV_DISPATCH(avx2_contains_prefix, sse2_contains_prefix, (a.m_data, b.m_data, n - 1));
+    for (; i < n - 1; ++i) {
         if ((a.m_data[i] & b.m_data[i]) != b.m_data[i])
             return false;
     }
@@ -152,6 +314,22 @@ bool fixed_bit_vector_manager::contains(fixed_bit_vector const& a, fixed_bit_vec
     return (last_word(a) & b_data) == b_data;
 }
 
+bool fixed_bit_vector_manager::all_pairs_nonzero(fixed_bit_vector const& bv) const {
+    unsigned n = num_words();
+    if (n == 0)
+        return true;
+    unsigned i = FBV_DISPATCH(avx2_pairs_prefix, sse2_pairs_prefix, (bv.m_data, n - 1));
+    unsigned w;
+    for (; i < n - 1; ++i) {
+        w = bv.m_data[i];
+        w = w | (w << 1) | 0x55555555;
+        if (w != 0xFFFFFFFF) return false;
+    }
+    w = last_word(bv);
+    w = w | (w << 1) | 0x55555555 | ~m_mask;
+    return w == 0xFFFFFFFF;
+}
+
 std::ostream& fixed_bit_vector_manager::display(std::ostream& out, fixed_bit_vector const& b) const {
     unsigned i = num_bits();
     while (i > 0) {
@@ -85,6 +85,7 @@ class fixed_bit_vector_manager {
     unsigned               m_num_bytes;
     unsigned               m_num_words;
     unsigned               m_mask;
+    unsigned               m_simd; // vector instructions used by the word loops, see simd_level
     fixed_bit_vector       m_0;
 
     static unsigned num_words(unsigned num_bits) { 
@@ -92,7 +93,16 @@ class fixed_bit_vector_manager {
     }    
 
 public:
-    fixed_bit_vector_manager(unsigned num_bits);
+    /**
+       \brief \c use_simd allows vector instructions (SSE2, or AVX2 when the processor
+       supports it) in the word loops.
+    */
+    fixed_bit_vector_manager(unsigned num_bits, bool use_simd = true);
+
+    /**
+       \brief 0 if the word loops are scalar, 1 if they use SSE2, 2 if they use AVX2.
+    */
+    unsigned simd_level() const { return m_simd; }
 
     void reset() { m_alloc.reset(); }
     fixed_bit_vector* allocate();
@@ -116,6 +126,11 @@ public:
     bool equals(fixed_bit_vector const& a, fixed_bit_vector const& b) const;
     unsigned hash(fixed_bit_vector const& src) const;
     bool contains(fixed_bit_vector const& a, fixed_bit_vector const& b) const;
+    /**
+       \brief Return true if every pair of bits 2i, 2i+1 of \c bv has a bit set.
+       Bits beyond num_bits() are ignored.
+    */
+    bool all_pairs_nonzero(fixed_bit_vector const& bv) const;
     std::ostream& display(std::ostream& out, fixed_bit_vector const& b) const;    
     void set(fixed_bit_vector& dst, unsigned bit_idx) {
         SASSERT(bit_idx < num_bits());
@@ -568,6 +568,13 @@ void mpz_manager<SYNCH>::gcd(mpz const & a, mpz const & b, mpz & c) {
         // If a == b == INT_MIN
         set(c, r);
     }
+#ifndef _MP_GMP
+    else if (is_abs_uint64(a) && is_abs_uint64(b)) {
+        uint64 _a = is_small(a) ? static_cast<uint64>(a.m_val < 0 ? -i64(a) : i64(a)) : big_abs_to_uint64(a);
+        uint64 _b = is_small(b) ? static_cast<uint64>(b.m_val < 0 ? -i64(b) : i64(b)) : big_abs_to_uint64(b);
+        set(c, u64_gcd(_a, _b));
+    }
+#endif
     else {
 #ifdef _MP_GMP
         mpz_t * arg0;
@@ -1024,6 +1031,9 @@ void mpz_manager<SYNCH>::bitwise_or(mpz const & a, mpz const & b, mpz & c) {
         del(c);
         c.m_val = a.m_val | b.m_val;
     }
+    else if (is_uint64(a) && is_uint64(b)) {
+        set(c, get_uint64(a) | get_uint64(b));
+    }
     else {
 #ifndef _MP_GMP
         mpz a1, b1, a2, b2, m, tmp;
@@ -1073,6 +1083,9 @@ void mpz_manager<SYNCH>::bitwise_and(mpz const & a, mpz const & b, mpz & c) {
         del(c);
         c.m_val = a.m_val & b.m_val;
     }
+    else if (is_uint64(a) && is_uint64(b)) {
+        set(c, get_uint64(a) & get_uint64(b));
+    }
     else {
 #ifndef _MP_GMP
         mpz a1, b1, a2, b2, m, tmp;
@@ -1110,6 +1123,9 @@ void mpz_manager<SYNCH>::bitwise_xor(mpz const & a, mpz const & b, mpz & c) {
     if (is_small(a) && is_small(b)) {
         set_i64(c, i64(a) ^ i64(b));
     }
+    else if (is_uint64(a) && is_uint64(b)) {
+        set(c, get_uint64(a) ^ get_uint64(b));
+    }
     else {
 #ifndef _MP_GMP
         mpz a1, b1, a2, b2, m, tmp;
@@ -1155,6 +1171,13 @@ void mpz_manager<SYNCH>::bitwise_not(unsigned sz, mpz const & a, mpz & c) {
         int64 mask = (static_cast<int64>(1) << sz) - static_cast<int64>(1);
         set_i64(c, (~ i64(a)) & mask);
     }
+    else if (sz <= 64 && is_uint64(a)) {
+        uint64 v = ~get_uint64(a);
+        if (sz < 64) {
+            v &= (1ull << static_cast<uint64>(sz)) - 1ull;
+        }
+        set(c, v);
+    }
     else {
         mpz a1, a2, m, tmp;
         set(a1, a);
@@ -32,6 +32,52 @@ Revision History:
 unsigned u_gcd(unsigned u, unsigned v);
 uint64 u64_gcd(uint64 u, uint64 v);
 
+#if (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__)
+#define Z3_HAS_OVERFLOW_BUILTINS
+#endif
+
+/**
+   \brief Machine word arithmetic with overflow detection.
+   Return false if the result does not fit in an int64 or is INT64_MIN:
+   INT64_MIN cannot be negated in an int64, so mpz_manager::set_i64 must not
+   receive it.
+*/
+inline bool i64_add(int64 a, int64 b, int64 & r) {
+#ifdef Z3_HAS_OVERFLOW_BUILTINS
+    return !__builtin_add_overflow(a, b, &r) && r != INT64_MIN;
+#else
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a <= INT64_MIN - b))
+        return false;
+    r = a + b;
+    return true;
+#endif
+}
+
+inline bool i64_sub(int64 a, int64 b, int64 & r) {
+#ifdef Z3_HAS_OVERFLOW_BUILTINS
+    return !__builtin_sub_overflow(a, b, &r) && r != INT64_MIN;
+#else
+    if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a <= INT64_MIN + b))
+        return false;
+    r = a - b;
+    return true;
+#endif
+}
+
+inline bool i64_mul(int64 a, int64 b, int64 & r) {
+#ifdef Z3_HAS_OVERFLOW_BUILTINS
+    return !__builtin_mul_overflow(a, b, &r) && r != INT64_MIN;
+#else
+    // operands are never INT64_MIN (see mpz_manager::get_i64).
+    uint64 ua = a < 0 ? -a : a;
+    uint64 ub = b < 0 ? -b : b;
+    if (ua != 0 && ub > static_cast<uint64>(INT64_MAX) / ua)
+        return false;
+    r = a * b;
+    return true;
+#endif
+}
+
 #ifdef _MP_GMP
 typedef unsigned digit_t;
 #endif
@@ -207,6 +253,28 @@ class mpz_manager {
 
     void set_big_ui64(mpz & c, uint64 v);
 
+    /**
+       \brief Store the value of \c a in \c r if it fits in an int64 different from INT64_MIN.
+       Small numbers always fit, big numbers only if they have at most 64 bits.
+    */
+    static bool get_i64(mpz const & a, int64 & r) {
+        if (is_small(a)) {
+            r = a.m_val;
+            return true;
+        }
+#ifndef _MP_GMP
+        if (!is_abs_uint64(a))
+            return false;
+        uint64 num = big_abs_to_uint64(a);
+        if ((num >> 63) != 0)
+            return false;
+        r = a.m_val < 0 ? -static_cast<int64>(num) : static_cast<int64>(num);
+        return true;
+#else
+        return false;
+#endif
+    }
+
 #ifndef _MP_GMP
     static unsigned capacity(mpz const & c) { return c.m_ptr->m_capacity; }
 
@@ -345,9 +413,13 @@ public:
     
     void add(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " + " << to_string(b) << " == ";); 
+        int64 _a, _b, _c;
         if (is_small(a) && is_small(b)) {
             set_i64(c, i64(a) + i64(b));
         }
+        else if (get_i64(a, _a) && get_i64(b, _b) && i64_add(_a, _b, _c)) {
+            set_i64(c, _c);
+        }
         else {
             MPZ_BEGIN_CRITICAL();
             big_add(a, b, c);
@@ -358,9 +430,13 @@ public:
 
     void sub(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " - " << to_string(b) << " == ";); 
+        int64 _a, _b, _c;
         if (is_small(a) && is_small(b)) {
             set_i64(c, i64(a) - i64(b));
         }
+        else if (get_i64(a, _a) && get_i64(b, _b) && i64_sub(_a, _b, _c)) {
+            set_i64(c, _c);
+        }
         else {
             MPZ_BEGIN_CRITICAL();
             big_sub(a, b, c);
@@ -375,9 +451,13 @@ public:
 
     void mul(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " * " << to_string(b) << " == ";); 
+        int64 _a, _b, _c;
         if (is_small(a) && is_small(b)) {
             set_i64(c, i64(a) * i64(b));
         }
+        else if (get_i64(a, _a) && get_i64(b, _b) && i64_mul(_a, _b, _c)) {
+            set_i64(c, _c);
+        }
         else {
             MPZ_BEGIN_CRITICAL();
             big_mul(a, b, c);
@@ -422,9 +502,8 @@ public:
 
     void machine_div_rem(mpz const & a, mpz const & b, mpz & q, mpz & r) {
         STRACE("mpz", tout << "[mpz-ext] divrem(" << to_string(a) << ",  " << to_string(b) << ") == ";); 
-        if (is_small(a) && is_small(b)) {
-            int64 _a = i64(a);
-            int64 _b = i64(b);
+        int64 _a, _b;
+        if (get_i64(a, _a) && get_i64(b, _b)) {
             set_i64(q, _a / _b);
             set_i64(r, _a % _b);
         }
@@ -438,8 +517,9 @@ public:
 
     void machine_div(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz-ext] machine-div(" << to_string(a) << ",  " << to_string(b) << ") == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) / i64(b));
+        int64 _a, _b;
+        if (get_i64(a, _a) && get_i64(b, _b)) {
+            set_i64(c, _a / _b);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -451,8 +531,9 @@ public:
 
     void rem(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz-ext] rem(" << to_string(a) << ",  " << to_string(b) << ") == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) % i64(b));
+        int64 _a, _b;
+        if (get_i64(a, _a) && get_i64(b, _b)) {
+            set_i64(c, _a % _b);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -20,6 +20,7 @@ Revision History:
 #define OBJ_MARK_H_
 
 #include"bit_vector.h"
+#include"vector.h"
 
 template<typename T>
 struct default_t2uint {
@@ -50,4 +51,42 @@ public:
     void reset() { m_marks.reset(); }
 };
 
+/**
+   \brief Marks indexed by object id that are stamped with the current epoch.
+   reset() only bumps the epoch, so a single instance can be reused for many
+   traversals without clearing (or reallocating) the mark array.
+*/
+template<typename T, typename T2UInt = default_t2uint<T> >
+class obj_stamp_mark {
+    T2UInt            m_proc;
+    svector<unsigned> m_stamps;
+    unsigned          m_epoch;
+public:
+    obj_stamp_mark(T2UInt const & p = T2UInt()):m_proc(p), m_epoch(1) {}
+    bool is_marked(T const & obj) const {
+        unsigned id = m_proc(obj);
+        return id < m_stamps.size() && m_stamps[id] == m_epoch;
+    }
+    bool is_marked(T * obj) const { return is_marked(*obj); }
+    void mark(T const & obj, bool flag) {
+        unsigned id = m_proc(obj);
+        if (id >= m_stamps.size()) {
+            m_stamps.resize(id+1, 0);
+        }
+        m_stamps[id] = flag ? m_epoch : 0;
+    }
+    void mark(T const * obj, bool flag) { mark(*obj, flag); }
+    void mark(T const & obj) { mark(obj, true); }
+    void mark(T const * obj) { mark(obj, true); }
+    void reset() {
+        ++m_epoch;
+        if (m_epoch == 0) {
+            // wrapped around: stale stamps could collide with the new epoch.
+            m_stamps.reset();
+            m_epoch = 1;
+        }
+    }
+    void finalize() { m_stamps.finalize(); m_epoch = 1; }
+};
+
 #endif /* OBJ_MARK_H_ */